@@ -0,0 +1,330 @@
+// Monte Carlo balance harness: plays AI-vs-AI battles on every core and
+// reports win rates with 95% Wilson intervals, average battle length, and
+// how each card being played relates to winning.
+//
+//   balance [--battles N] [--threads N] [--seed N] [--max-turns N]
+//           [--a DECK] [--b DECK]... [--costs MIN:MAX:STEP] [--mcts N]
+//
+// DECK is "default", "cost:N" (a fresh generate_deck_with_cost(N) deck for
+// every battle) or an explicit list such as "Turret*3,Shield Mk2,Bomb" of at
+// most BATTLE_DECK_CAPACITY cards.
+// Side A defaults to the default decklist; every --b and every cost in
+// --costs is one matchup against it. --battles is per matchup. Battle i of
+// matchup m is seeded from (seed, m, i) alone, so the numbers don't depend
+// on the thread count. --mcts N has side B plan with the search AI, N
+// iterations a turn, instead of the built-in plan.
+
+#include "battle_sim.h"
+#include "battle_ai.h"
+#include "cards.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static_assert(cards::COUNT <= 64, "played cards are tracked in 64-bit masks");
+
+struct DeckSpec {
+    std::string label;
+    int cost = 0;            // > 0: generated per battle
+    std::vector<CardId> cards; // otherwise fixed
+};
+
+struct MatchupStats {
+    long long battles = 0;
+    long long wins[2] = {};
+    long long draws = 0;
+    long long turns = 0;
+};
+
+// Per catalog card, from the point of view of the side holding it
+struct CardStats {
+    long long in_deck = 0;
+    long long played = 0;
+    long long played_wins = 0;
+    long long unplayed_wins = 0;
+};
+
+struct WorkerStats {
+    std::vector<MatchupStats> matchups;
+    std::vector<CardStats> cards;
+};
+
+static uint64_t card_mask(const std::vector<CardId>& deck) {
+    uint64_t mask = 0;
+    for (CardId id : deck) mask |= 1ull << id;
+    return mask;
+}
+
+static bool parse_deck(const char* text, DeckSpec& out) {
+    out.label = text;
+    if (std::strcmp(text, "default") == 0) {
+        out.cards = cards::default_deck();
+        return true;
+    }
+    if (std::strncmp(text, "cost:", 5) == 0) {
+        out.cost = std::atoi(text + 5);
+        return out.cost > 0;
+    }
+    std::string list = text;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        std::string item = list.substr(pos, end - pos);
+        int copies = 1;
+        size_t star = item.rfind('*');
+        if (star != std::string::npos) {
+            copies = std::atoi(item.c_str() + star + 1);
+            item.resize(star);
+        }
+        while (!item.empty() && item.front() == ' ') item.erase(item.begin());
+        while (!item.empty() && item.back() == ' ') item.pop_back();
+        const CardDef* card = cards::find_by_name(item);
+        if (!card) {
+            std::fprintf(stderr, "unknown card \"%s\"\n", item.c_str());
+            return false;
+        }
+        for (int i = 0; i < copies; ++i) out.cards.push_back(card->id);
+        pos = end + 1;
+    }
+    if (out.cards.size() > BATTLE_DECK_CAPACITY) {
+        std::fprintf(stderr, "deck \"%s\" has %zu cards, more than %d\n", text, out.cards.size(), BATTLE_DECK_CAPACITY);
+        return false;
+    }
+    return !out.cards.empty();
+}
+
+static std::vector<CardId> build_deck(const DeckSpec& spec, BattleRng& rng) {
+    if (spec.cost > 0) return cards::generate_deck_with_cost(spec.cost, rng);
+    return spec.cards;
+}
+
+// Applies a side's planned moves, noting which catalog cards were played
+static void play_turn(BattleState& st, BattleSide side, const TurnInputs& plan, uint64_t& played) {
+    const SideState& self = get_side_state(st, side);
+    for (const PlayAction& action : plan) {
+        CardId id = (action.hand_idx < self.hand.size()) ? self.hand[action.hand_idx] : CARD_NONE;
+        if (play_card(st, side, action)) played |= 1ull << id;
+    }
+}
+
+static void run_battle(const DeckSpec& a, const DeckSpec& b, uint64_t seed, int max_turns, long long mcts_iterations,
+                       MatchupStats& stats, std::vector<CardStats>& card_stats) {
+    BattleRng deck_rng;
+    deck_rng.seed(seed ^ 0xD1B54A32D192ED03ull);
+    std::vector<CardId> decks[2] = {build_deck(a, deck_rng), build_deck(b, deck_rng)};
+
+    BattleState st;
+    init_battle_state(st, decks[0], decks[1], seed);
+
+    uint64_t in_deck[2] = {card_mask(decks[0]), card_mask(decks[1])};
+    // Field effect cards act as soon as the battle starts
+    uint64_t played[2] = {0, 0};
+    for (int s = 0; s < 2; ++s) {
+        for (CardId id : decks[s]) {
+            if (card_def(id).kind == CardKind::FIELD_EFFECT) played[s] |= 1ull << id;
+        }
+    }
+
+    int turns = 0;
+    while (!battle_over(st) && !is_stalemate(st) && turns < max_turns) {
+        // Both sides plan from the same state, as in the game
+        TurnInputs plan_b;
+        if (mcts_iterations > 0) {
+            MctsConfig config;
+            config.budget_ms = 0.0;
+            config.max_iterations = mcts_iterations;
+            config.threads = 1;
+            plan_b = mcts_plan_turn(st, BattleSide::OPPONENT, config);
+        } else {
+            plan_b = plan_turn(st, BattleSide::OPPONENT);
+        }
+        play_turn(st, BattleSide::PLAYER, plan_turn(st, BattleSide::PLAYER), played[0]);
+        play_turn(st, BattleSide::OPPONENT, plan_b, played[1]);
+        if (begin_resolution(st)) {
+            for (int step = 0; step < BATTLE_ATTACK_STEPS; ++step) resolve_attack_step(st, step);
+        }
+        ++turns;
+    }
+
+    bool won[2] = {st.player.hp > 0 && st.opponent.hp <= 0, st.opponent.hp > 0 && st.player.hp <= 0};
+    stats.battles++;
+    stats.turns += turns;
+    if (won[0]) stats.wins[0]++;
+    else if (won[1]) stats.wins[1]++;
+    else stats.draws++;
+
+    for (int s = 0; s < 2; ++s) {
+        for (size_t c = 0; c < card_stats.size(); ++c) {
+            uint64_t bit = 1ull << c;
+            if (!(in_deck[s] & bit)) continue;
+            CardStats& cs = card_stats[c];
+            cs.in_deck++;
+            if (played[s] & bit) {
+                cs.played++;
+                if (won[s]) cs.played_wins++;
+            } else if (won[s]) {
+                cs.unplayed_wins++;
+            }
+        }
+    }
+}
+
+static void wilson_interval(long long wins, long long n, double& lo, double& hi) {
+    if (n == 0) { lo = hi = 0.0; return; }
+    const double z = 1.96;
+    double p = (double)wins / n;
+    double denom = 1.0 + z * z / n;
+    double center = (p + z * z / (2.0 * n)) / denom;
+    double half = z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) / denom;
+    lo = center - half;
+    hi = center + half;
+}
+
+static uint64_t task_seed(uint64_t seed, int matchup, long long battle) {
+    return seed ^ ((uint64_t)matchup << 40) ^ (uint64_t)battle;
+}
+
+int main(int argc, char** argv) {
+    long long battles = 10000;
+    int threads = (int)std::thread::hardware_concurrency();
+    uint64_t seed = 1;
+    int max_turns = 100;
+    long long mcts_iterations = 0;
+    DeckSpec side_a;
+    bool have_a = false;
+    std::vector<DeckSpec> opponents;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--battles") == 0 && i + 1 < argc) {
+            battles = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--max-turns") == 0 && i + 1 < argc) {
+            max_turns = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--mcts") == 0 && i + 1 < argc) {
+            mcts_iterations = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--a") == 0 && i + 1 < argc) {
+            side_a = DeckSpec{};
+            if (!parse_deck(argv[++i], side_a)) return 1;
+            have_a = true;
+        } else if (std::strcmp(argv[i], "--b") == 0 && i + 1 < argc) {
+            DeckSpec spec;
+            if (!parse_deck(argv[++i], spec)) return 1;
+            opponents.push_back(spec);
+        } else if (std::strcmp(argv[i], "--costs") == 0 && i + 1 < argc) {
+            int lo = 0, hi = 0, step = 0;
+            if (std::sscanf(argv[++i], "%d:%d:%d", &lo, &hi, &step) != 3 || lo <= 0 || step <= 0) {
+                std::fprintf(stderr, "--costs takes MIN:MAX:STEP\n");
+                return 1;
+            }
+            for (int cost = lo; cost <= hi; cost += step) {
+                DeckSpec spec;
+                spec.label = "cost:" + std::to_string(cost);
+                spec.cost = cost;
+                opponents.push_back(spec);
+            }
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--battles N] [--threads N] [--seed N] [--max-turns N] "
+                         "[--a DECK] [--b DECK]... [--costs MIN:MAX:STEP] [--mcts N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!have_a) parse_deck("default", side_a);
+    if (opponents.empty()) {
+        for (int cost = 200; cost <= 2000; cost += 600) {
+            DeckSpec spec;
+            spec.label = "cost:" + std::to_string(cost);
+            spec.cost = cost;
+            opponents.push_back(spec);
+        }
+    }
+    if (threads < 1) threads = 1;
+
+    const size_t card_count = cards::COUNT;
+    const long long total = battles * (long long)opponents.size();
+    const long long chunk = 64;
+    std::atomic<long long> next{0};
+    WorkerStats merged{std::vector<MatchupStats>(opponents.size()), std::vector<CardStats>(card_count)};
+    std::mutex merge_mutex;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            WorkerStats local{std::vector<MatchupStats>(opponents.size()), std::vector<CardStats>(card_count)};
+            for (;;) {
+                long long first = next.fetch_add(chunk);
+                if (first >= total) break;
+                long long last = std::min(total, first + chunk);
+                for (long long task = first; task < last; ++task) {
+                    int m = (int)(task / battles);
+                    long long b = task % battles;
+                    run_battle(side_a, opponents[m], task_seed(seed, m, b), max_turns, mcts_iterations, local.matchups[m], local.cards);
+                }
+            }
+            std::lock_guard<std::mutex> lock(merge_mutex);
+            for (size_t m = 0; m < opponents.size(); ++m) {
+                MatchupStats& dst = merged.matchups[m];
+                const MatchupStats& src = local.matchups[m];
+                dst.battles += src.battles;
+                dst.wins[0] += src.wins[0];
+                dst.wins[1] += src.wins[1];
+                dst.draws += src.draws;
+                dst.turns += src.turns;
+            }
+            for (size_t c = 0; c < card_count; ++c) {
+                merged.cards[c].in_deck += local.cards[c].in_deck;
+                merged.cards[c].played += local.cards[c].played;
+                merged.cards[c].played_wins += local.cards[c].played_wins;
+                merged.cards[c].unplayed_wins += local.cards[c].unplayed_wins;
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-24s %-24s %9s %8s %17s %8s %7s %6s\n",
+                "A", "B", "battles", "A win%", "95% CI", "B win%", "draw%", "turns");
+    for (size_t m = 0; m < opponents.size(); ++m) {
+        const MatchupStats& ms = merged.matchups[m];
+        if (ms.battles == 0) continue;
+        double lo, hi;
+        wilson_interval(ms.wins[0], ms.battles, lo, hi);
+        std::printf("%-24.24s %-24.24s %9lld %8.2f   [%6.2f, %6.2f] %8.2f %7.2f %6.1f\n",
+                    side_a.label.c_str(), opponents[m].label.c_str(), ms.battles,
+                    100.0 * ms.wins[0] / ms.battles, 100.0 * lo, 100.0 * hi,
+                    100.0 * ms.wins[1] / ms.battles, 100.0 * ms.draws / ms.battles,
+                    (double)ms.turns / ms.battles);
+    }
+
+    // Win rate of the holding side when the card was played against when it
+    // sat in the deck unplayed; correlation, not a controlled experiment
+    std::printf("\n%-20s %10s %8s %13s %15s %8s\n", "card", "in deck", "played%", "win% played", "win% unplayed", "lift");
+    for (size_t c = 0; c < card_count; ++c) {
+        const CardStats& cs = merged.cards[c];
+        if (cs.in_deck == 0) continue;
+        long long unplayed = cs.in_deck - cs.played;
+        double played_rate = cs.played ? 100.0 * cs.played_wins / cs.played : 0.0;
+        double unplayed_rate = unplayed ? 100.0 * cs.unplayed_wins / unplayed : 0.0;
+        std::printf("%-20s %10lld %8.1f %13.2f %15.2f %+8.2f\n",
+                    cards::all()[c].name, cs.in_deck, 100.0 * cs.played / cs.in_deck,
+                    played_rate, unplayed_rate, (cs.played && unplayed) ? played_rate - unplayed_rate : 0.0);
+    }
+
+    std::fprintf(stderr, "%lld battles on %d threads in %.2f s: %.0f battles/s\n",
+                 total, threads, seconds, seconds > 0.0 ? total / seconds : 0.0);
+    return 0;
+}
@@ -1,84 +1,55 @@
 #include "battle.h"
+#include "battle_ai.h"
 #include "cards.hpp"
 #include "overworld.h"
 #include "states.hpp"
+#include "geometry.h"
+#include "particles.h"
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_opengl3.h"
 #include <emscripten.h>
 #include <algorithm>
 #include <random>
-#include <ctime>
 #include <cmath>
 
-// Internal battle helper
-static std::mt19937& battle_rng() {
-    static std::mt19937 rng(time(0));
-    return rng;
-}
-
-static const char* side_label(BattleSide side) {
-    return (side == BattleSide::PLAYER) ? "Player" : "Opponent";
-}
+bool g_battle_turbo = false;
+bool g_battle_auto = false;
 
-static BattleSide side_of_state(const SideState& side) {
-    return (&side == &g_battle.player) ? BattleSide::PLAYER : BattleSide::OPPONENT;
-}
+// The opponent searches its next turn while the player plans theirs
+static MctsPonder g_opponent_ai;
+// Search time per frame in builds without worker threads (ms)
+static constexpr double k_ponder_slice_ms = 6.0;
 
-void shuffle_deck(std::vector<Card>& deck) {
-    std::shuffle(deck.begin(), deck.end(), battle_rng());
-}
-
-static bool side_has_play_resources(const SideState& side) {
-    if (!side.hand.empty()) return true;
-    if (!side.deck.empty()) return true;
-    for (int r = 0; r < 2; ++r) {
-        for (int c = 0; c < 6; ++c) {
-            if (side.field[r][c][0].hp > 0) return true;
-        }
+// The player's moves go through here so the replay records them
+static void player_play(const PlayAction& action) {
+    if (play_card(g_battle.state, BattleSide::PLAYER, action)) {
+        g_battle.pending_inputs.push_back(action);
     }
-    return false;
-}
-
-static bool is_stalemate(const BattleState& st) {
-    return !side_has_play_resources(st.player) && !side_has_play_resources(st.opponent);
 }
 
-static std::vector<Card> pick_reward_cards(int difficulty, int count) {
-    std::vector<const Card*> candidates;
-    for (const Card* card : cards::all()) {
-        if (card && card->cost < difficulty) {
-            candidates.push_back(card);
-        }
+static void start_opponent_search(const BattleState& st) {
+    if (battle_over(st)) {
+        mcts_ponder_cancel(g_opponent_ai);
+        return;
     }
-    if (candidates.empty()) return {};
-
-    std::sort(candidates.begin(), candidates.end(), [](const Card* a, const Card* b) {
-        return a->cost > b->cost;
-    });
-    if (candidates.size() > 10) candidates.resize(10);
+    mcts_ponder_start(g_opponent_ai, st, BattleSide::OPPONENT, MctsConfig{});
+    g_battle.search_started = ImGui::GetTime();
+}
 
-    std::shuffle(candidates.begin(), candidates.end(), battle_rng());
-    count = std::min<int>(count, candidates.size());
+// count of the 10 priciest cards under difficulty, in random order
+static std::vector<CardId> pick_reward_cards(int difficulty, int count, BattleRng& rng) {
+    std::span<const CardId> affordable = cards::cheaper_than(difficulty);
+    std::span<const CardId> candidates = affordable.last(std::min<size_t>(affordable.size(), 10));
+    std::vector<CardId> pool(candidates.rbegin(), candidates.rend());
+    count = std::min<int>(count, pool.size());
 
-    std::vector<Card> rewards;
-    rewards.reserve(count);
+    // Only the picked prefix needs shuffling
     for (int i = 0; i < count; ++i) {
-        rewards.push_back(*candidates[i]);
+        std::swap(pool[i], pool[i + rng.below((int)pool.size() - i)]);
     }
-    return rewards;
-}
-
-SideState& get_side_state(BattleState& state, BattleSide side) {
-    return (side == BattleSide::PLAYER) ? state.player : state.opponent;
-}
-
-const SideState& get_side_state(const BattleState& state, BattleSide side) {
-    return (side == BattleSide::PLAYER) ? state.player : state.opponent;
-}
-
-static Card make_empty_card() {
-    return {"", 0, 0, 0, 0, 0, CardType::DEFAULT, CardKind::NORMAL, {}, std::nullopt, {}};
+    pool.resize(count);
+    return pool;
 }
 
 static ImVec4 lighten_color(ImVec4 color, float delta) {
@@ -90,16 +61,6 @@ static ImVec4 lighten_color(ImVec4 color, float delta) {
     );
 }
 
-static const char* card_kind_label(CardKind kind) {
-    switch (kind) {
-        case CardKind::NORMAL: return "Normal";
-        case CardKind::SPECIAL: return "Special";
-        case CardKind::IMMEDIATE: return "Immediate";
-        case CardKind::FIELD_EFFECT: return "Field";
-    }
-    return "Normal";
-}
-
 static ImVec4 card_kind_color(CardKind kind) {
     switch (kind) {
         case CardKind::NORMAL: return ImVec4(0.30f, 0.35f, 0.45f, 1.0f);
@@ -123,32 +84,65 @@ static void pop_card_kind_colors() {
     ImGui::PopStyleColor(3);
 }
 
-static void append_log(const std::string& entry) {
-    g_battle.action_log.push_back(entry);
-    const size_t max_entries = 200;
-    if (g_battle.action_log.size() > max_entries) {
-        g_battle.action_log.erase(g_battle.action_log.begin());
-    }
+static void log_event(BattleEventKind kind, CardId card = CARD_NONE, int amount = 0) {
+    BattleEvent event;
+    event.kind = kind;
+    event.card = card;
+    event.amount = amount;
+    battle_event(g_battle.state, event);
 }
 
-BattleSide opposite_side(BattleSide side) {
-    return (side == BattleSide::PLAYER) ? BattleSide::OPPONENT : BattleSide::PLAYER;
+// Damage and healing per slot and ship since marker_start, indexed by side
+// (0 player, 1 opponent); summed again only when events arrive
+struct BattleMarkers {
+    int slot_damage[2][2][6];
+    int slot_heal[2][2][6];
+    int ship_damage[2];
+    int ship_heal[2];
+};
+
+static int side_index(BattleSide side) {
+    return side == BattleSide::PLAYER ? 0 : 1;
 }
 
-static void reset_side_damage(SideState& side) {
-    side.ship_last_damage = 0;
-    side.ship_last_heal = 0;
-    for (int r = 0; r < 2; ++r) {
-        for (int c = 0; c < 6; ++c) {
-            side.slot_last_damage[r][c] = 0;
-            side.slot_last_heal[r][c] = 0;
+// Ship damage recorded from seq on: effects, and attacks that got through
+static void sum_ship_damage(const BattleEventLog& events, uint32_t seq, int (&out)[2]) {
+    out[0] = out[1] = 0;
+    for (seq = std::max(seq, events.first()); seq < events.total; ++seq) {
+        const BattleEvent& e = events.at(seq);
+        if (e.kind == BattleEventKind::SHIP_DAMAGED ||
+            (e.kind == BattleEventKind::ATTACK && e.target_col < 0)) {
+            // An attack's side is the attacker's
+            int s = side_index(e.side);
+            out[e.kind == BattleEventKind::ATTACK ? 1 - s : s] += e.amount;
         }
     }
 }
 
-static void reset_damage_tracking(BattleState& state) {
-    reset_side_damage(state.player);
-    reset_side_damage(state.opponent);
+static BattleMarkers g_markers;
+// Event range g_markers was summed over; a new battle sets it stale
+static uint32_t g_markers_start = UINT32_MAX;
+static uint32_t g_markers_total = UINT32_MAX;
+
+static const BattleMarkers& battle_markers() {
+    const BattleEventLog& events = g_battle.events;
+    if (g_markers_start == g_battle.marker_start && g_markers_total == events.total) return g_markers;
+    g_markers_start = g_battle.marker_start;
+    g_markers_total = events.total;
+    g_markers = BattleMarkers{};
+    sum_ship_damage(events, g_markers_start, g_markers.ship_damage);
+    for (uint32_t seq = std::max(g_markers_start, events.first()); seq < events.total; ++seq) {
+        const BattleEvent& e = events.at(seq);
+        int s = side_index(e.side);
+        switch (e.kind) {
+        case BattleEventKind::SLOT_DAMAGED: g_markers.slot_damage[s][e.row][e.col] += e.amount; break;
+        case BattleEventKind::SLOT_HEALED:
+        case BattleEventKind::SLOT_MENDED: g_markers.slot_heal[s][e.row][e.col] += e.amount; break;
+        case BattleEventKind::SHIP_HEALED: g_markers.ship_heal[s] += e.amount; break;
+        default: break;
+        }
+    }
+    return g_markers;
 }
 
 static void draw_damage_marker(int damage) {
@@ -177,294 +171,157 @@ static void draw_heal_marker(int heal) {
     ImGui::GetWindowDrawList()->AddText(pos, IM_COL32(80, 220, 120, 255), text.c_str());
 }
 
-static bool column_has_card(const std::vector<Card> (&field)[2][6], int col) {
-    for (int r = 0; r < 2; ++r) {
-        if (field[r][col][0].hp > 0) return true;
-    }
-    return false;
-}
-
-static int find_target_column(const std::vector<Card> (&field)[2][6], int start_col) {
-    // restrict targeting to the same half of the board; columns 0-2 and 3-5
-    // center columns (2 and 3) only target straight ahead
-    int min_col, max_col;
-    if (start_col == 2 || start_col == 3) {
-        min_col = max_col = start_col;
-    } else {
-        min_col = (start_col < 3) ? 0 : 3;
-        max_col = (start_col < 3) ? 2 : 5;
-    }
-
-    if (column_has_card(field, start_col)) return start_col;
-
-    if (start_col < 3) {
-        for (int col = start_col + 1; col <= max_col; ++col) {
-            if (column_has_card(field, col)) return col;
-        }
-    } else {
-        for (int col = start_col - 1; col >= min_col; --col) {
-            if (column_has_card(field, col)) return col;
-        }
-    }
-    return -1;
-}
-
-static bool center_columns_clear(const std::vector<Card> (&field)[2][6], int start_col) {
-    // Only require the near-center column to be empty for ship hits
-    if (start_col < 3) return !column_has_card(field, 2);
-    return !column_has_card(field, 3);
-}
-
-static void cleanup_destroyed_cards();
-
-static int effective_damage(const Card& card, const SideState& side) {
-    return static_cast<int>(std::lround(card.dmg * side.damage_multiplier));
-}
-
-void card_took_damage_trigger(SideState& side, int row, int col, int amount) {
-    if (amount <= 0) return;
-    if (row < 0 || row >= 2 || col < 0 || col >= 6) return;
-    if (side.field[row][col].empty()) return;
-    Card& card = side.field[row][col][0];
-    if (card.name == "Masochist") {
-        heal_ship(side, 500);
-    }
-}
-
-static void deal_damage_to_slot(SideState& side, int row, int col, int dmg) {
-    if (dmg <= 0) return;
-    Card& target = side.field[row][col][0];
-    if (target.hp <= 0) return;
-    int applied = std::min(dmg, target.hp);
-    target.hp -= applied;
-    side.slot_last_damage[row][col] += applied;
-    card_took_damage_trigger(side, row, col, applied);
-}
-
-void deal_damage_to_ship(SideState& side, int dmg) {
-    if (dmg <= 0) return;
-    int applied = std::min(dmg, side.hp);
-    side.hp -= applied;
-    side.ship_last_damage += applied;
-    BattleSide bside = side_of_state(side);
-    append_log(std::string("Ship of ") + side_label(bside) + " took " + std::to_string(applied) + " damage");
-}
-
-void heal_ship(SideState& side, int amount) {
-    if (amount <= 0) return;
-    side.hp += amount;
-    side.ship_last_heal += amount;
-    BattleSide bside = side_of_state(side);
-    append_log(std::string("Ship of ") + side_label(bside) + " healed " + std::to_string(amount));
-}
-
-static void heal_slot(SideState& side, int row, int col, int amount) {
-    Card& target = side.field[row][col][0];
-    if (target.hp <= 0 || amount <= 0) return;
-    int before = target.hp;
-    target.hp = std::min(target.max_hp, target.hp + amount);
-    int healed = target.hp - before;
-    if (healed > 0) {
-        side.slot_last_heal[row][col] += healed;
-        BattleSide bside = side_of_state(side);
-        append_log(std::string("Card ") + target.name + " from " + side_label(bside) + " at row " +
-                   std::to_string(row) + " col " + std::to_string(col) + " healed " + std::to_string(healed));
-    }
-}
-
-static void apply_card_effect(BattleState& state, BattleSide side, Card& card, int row, int col) {
-    if (card.effect) {
-        std::string loc = (row >= 0 && col >= 0) ? (" at row " + std::to_string(row) + " col " + std::to_string(col)) : "";
-        std::string desc = card.effect_description ? (": " + *card.effect_description) : "";
-        append_log(std::string("Card ") + card.name + " (" + card_kind_label(card.kind) + ") from " + side_label(side) + " activated" + loc + desc);
-        card.state.times_used++;
-        card.effect(state, side, row, col);
-        if (card.hp <= 0 && card.name != "") {
-            append_log(std::string("Card ") + card.name + " from " + side_label(side) + " was destroyed after activation");
-        }
-        cleanup_destroyed_cards();
-    }
-}
-
 // Screen-space helpers for animation
 static ImVec2 g_player_slot_centers[2][6];
 static ImVec2 g_opponent_slot_centers[2][6];
 static ImVec2 g_player_ship_pos(0, 0);
 static ImVec2 g_opponent_ship_pos(0, 0);
 
-static constexpr float k_anim_wait = 1.0f;
-static constexpr float k_anim_bolt_time = 0.35f;
-static constexpr float k_anim_post_wait = 1.0f;
-static constexpr float k_anim_step_time = k_anim_bolt_time + k_anim_post_wait;
-static constexpr int k_attack_phase_cols[3][2] = {{0, 5}, {1, 4}, {2, 3}};
+// Screen-space (pixel) particles: bolt impacts, wrecked cards, ship hits
+static ParticleSystem g_battle_particles;
 
-static void cleanup_destroyed_cards_for_side(SideState& side) {
-    for (int r = 0; r < 2; ++r) {
-        for (int c = 0; c < 6; ++c) {
-            Card& card = side.field[r][c][0];
-            if (card.hp <= 0 && card.name != "") {
-                BattleSide side_enum = side_of_state(side);
-                append_log(std::string("Card ") + card.name + " from " + side_label(side_enum)
-                           + " on row " + std::to_string(r) + " col " + std::to_string(c) + " destroyed");
-                card = make_empty_card();
-            }
-        }
-    }
-}
-
-static void cleanup_destroyed_cards() {
-    cleanup_destroyed_cards_for_side(g_battle.player);
-    cleanup_destroyed_cards_for_side(g_battle.opponent);
+static void emit_battle_burst(ImVec2 at, int count, float speed, float life, float r, float g, float b) {
+    ParticleBurst burst;
+    burst.x = at.x;
+    burst.y = at.y;
+    burst.count = count;
+    burst.speed = speed;
+    burst.life = life;
+    burst.r = r; burst.g = g; burst.b = b;
+    g_battle_particles.emit(burst);
 }
 
-static void apply_attacks_for_side(BattleSide attacker_side, int c) {
-    SideState& attacker = get_side_state(g_battle, attacker_side);
-    SideState& defender = get_side_state(g_battle, opposite_side(attacker_side));
-    auto& attacker_field = attacker.field;
-    auto& defender_field = defender.field;
-
-    for (int r = 0; r < 2; r++) {
-        if (g_battle.skip_attack_phase) return;
-
-        Card& attacker_card = attacker_field[r][c][0];
-        if (attacker_card.hp <= 0) continue;
-
-        apply_card_effect(g_battle, attacker_side, attacker_card, r, c);
-        if (attacker_card.hp <= 0) continue;
-        if (attacker_card.state.skip_this_turn) {
-            attacker_card.state.skip_this_turn = false;
-            continue;
-        }
+static void emit_ship_hit(BattleSide side, int amount) {
+    if (amount <= 0) return;
+    ImVec2 at = (side == BattleSide::PLAYER) ? g_player_ship_pos : g_opponent_ship_pos;
+    // Bigger hits throw more debris
+    int count = std::min(400, 40 + amount / 5);
+    emit_battle_burst(at, count, 260.0f, 0.9f, 1.0f, 0.55f, 0.15f);
+}
+
+// Field button text, rebuilt only when the card's name, HP or damage change
+struct SlotLabel {
+    CardId id = CARD_NONE;
+    int hp = -1;
+    int dmg = -1;
+    std::string text;
+};
 
-        int remaining_dmg = effective_damage(attacker_card, attacker);
-        if (remaining_dmg <= 0) continue;
+static SlotLabel g_player_slot_labels[2][6];
+static SlotLabel g_opponent_slot_labels[2][6];
+
+static const char* slot_label(SlotLabel& label, const Card& card) {
+    if (label.hp != card.hp || label.dmg != card.dmg || label.id != card.id) {
+        label.id = card.id;
+        label.hp = card.hp;
+        label.dmg = card.dmg;
+        label.text = std::string(card.def().name) + "\nHP:" + std::to_string(card.hp) + "\nDMG:" + std::to_string(card.dmg);
+    }
+    return label.text.c_str();
+}
+
+// The turn as it would resolve with one more card placed and nothing from
+// the opponent; rebuilt only when the state or the hovered slot changes
+struct PlacementPreview {
+    uint32_t event_total = UINT32_MAX;
+    PlayAction action{-1, -1, -1};
+    bool attacks = false;
+    int target_col = -1;
+    int damage = 0;
+    int ship_damage[2] = {0, 0};
+    int cards_lost[2] = {0, 0};
+};
 
-        int target_col = find_target_column(defender_field, c);
-        int total_unit_damage = 0;
-        int total_ship_damage = 0;
+static PlacementPreview g_preview;
+
+static const PlacementPreview& placement_preview(const PlayAction& action) {
+    if (g_preview.event_total == g_battle.events.total && g_preview.action.hand_idx == action.hand_idx &&
+        g_preview.action.row == action.row && g_preview.action.col == action.col) {
+        return g_preview;
+    }
+    static BattleEventLog events;
+    events.clear();
+    BattleState sim = g_battle.state;
+    sim.events = &events;
+    play_card(sim, BattleSide::PLAYER, action);
+    if (begin_resolution(sim)) {
+        for (int step = 0; step < BATTLE_ATTACK_STEPS; ++step) resolve_attack_step(sim, step);
+    }
+
+    g_preview = PlacementPreview{};
+    g_preview.event_total = g_battle.events.total;
+    g_preview.action = action;
+    sum_ship_damage(events, 0, g_preview.ship_damage);
+    for (uint32_t seq = events.first(); seq < events.total; ++seq) {
+        const BattleEvent& e = events.at(seq);
+        if (e.kind == BattleEventKind::DESTROYED) {
+            g_preview.cards_lost[side_index(e.side)]++;
+        } else if (e.kind == BattleEventKind::ATTACK && e.side == BattleSide::PLAYER && e.row == action.row &&
+                   e.col == action.col) {
+            g_preview.attacks = true;
+            g_preview.target_col = e.target_col;
+            g_preview.damage = e.amount;
+        }
+    }
+    return g_preview;
+}
+
+static void render_placement_preview(const PlayAction& action) {
+    const PlacementPreview& preview = placement_preview(action);
+    ImGui::BeginTooltip();
+    ImGui::TextUnformatted("Predicted this turn, if the opponent plays nothing:");
+    if (!preview.attacks) ImGui::TextUnformatted("This card: no attack");
+    else if (preview.target_col >= 0) ImGui::Text("This card: hits column %d for %d", preview.target_col, preview.damage);
+    else if (preview.damage > 0) ImGui::Text("This card: hits the ship for %d", preview.damage);
+    else ImGui::TextUnformatted("This card: no target");
+    ImGui::Text("Opponent: ship -%d, %d cards destroyed", preview.ship_damage[1], preview.cards_lost[1]);
+    ImGui::Text("You: ship -%d, %d cards lost", preview.ship_damage[0], preview.cards_lost[0]);
+    ImGui::EndTooltip();
+}
+
+// What a resolution step changes, so its effects can be shown afterwards
+struct BoardSnapshot {
+    uint32_t event_seq;
+    bool occupied[2][2][6];
+};
 
-        if (target_col >= 0) {
-            int row_order[2] = {0, 1};
-            if (attacker_side == BattleSide::PLAYER) {
-                row_order[0] = 1; row_order[1] = 0; // prioritize opponent bottom row
+static BoardSnapshot snapshot_board(const BattleState& st) {
+    BoardSnapshot snap;
+    snap.event_seq = st.events ? st.events->total : 0;
+    for (int s = 0; s < 2; ++s) {
+        const SideState& side = get_side_state(st, s == 0 ? BattleSide::PLAYER : BattleSide::OPPONENT);
+        for (int r = 0; r < 2; ++r) {
+            for (int c = 0; c < 6; ++c) {
+                snap.occupied[s][r][c] = !side.field[r][c].empty();
             }
-            for (int i = 0; i < 2 && remaining_dmg > 0; ++i) {
-                int drow = row_order[i];
-                Card& defender_card = defender_field[drow][target_col][0];
-                if (defender_card.hp <= 0) continue;
-
-                int dmg_to_deal = std::min(remaining_dmg, defender_card.hp);
-                defender_card.hp -= dmg_to_deal;
-                remaining_dmg -= dmg_to_deal;
-                defender.slot_last_damage[drow][target_col] += dmg_to_deal;
-                total_unit_damage += dmg_to_deal;
-            }
-        } else if (remaining_dmg > 0 && center_columns_clear(defender_field, c)) {
-            defender.hp -= remaining_dmg;
-            defender.ship_last_damage += remaining_dmg;
-            total_ship_damage = remaining_dmg;
-            remaining_dmg = 0;
-        }
-
-        std::string attack_log = std::string("Card ") + attacker_card.name + " (" + card_kind_label(attacker_card.kind) + ") from " +
-            side_label(attacker_side) + " at row " + std::to_string(r) + " col " + std::to_string(c);
-        if (target_col >= 0) {
-            attack_log += " attacked column " + std::to_string(target_col) + " for " + std::to_string(total_unit_damage) + " damage";
-        } else if (total_ship_damage > 0) {
-            attack_log += " attacked the ship for " + std::to_string(total_ship_damage) + " damage";
-        } else {
-            attack_log += " had no available target";
-        }
-        std::string special = attacker_card.effect_description ? *attacker_card.effect_description : "None";
-        attack_log += " (special effect: " + special + ")";
-        append_log(attack_log);
-    }
-}
-
-static void apply_attacks_for_column(int c) {
-    apply_attacks_for_side(BattleSide::PLAYER, c);
-    apply_attacks_for_side(BattleSide::OPPONENT, c);
-    cleanup_destroyed_cards();
-}
-
-// --- Card effect helpers ----------------------------------------------------
-
-void deal_damage_to_all_slots(SideState& side, int amount) {
-    for (int r = 0; r < 2; ++r) {
-        for (int c = 0; c < 6; ++c) {
-            deal_damage_to_slot(side, r, c, amount);
-        }
-    }
-}
-
-void heal_all_slots(SideState& side, int amount) {
-    for (int r = 0; r < 2; ++r) {
-        for (int c = 0; c < 6; ++c) {
-            heal_slot(side, r, c, amount);
-        }
-    }
-}
-
-static void draw_cards(SideState& side, int count) {
-    for (int i = 0; i < count && !side.deck.empty(); ++i) {
-        side.hand.push_back(side.deck.back());
-        side.deck.pop_back();
-    }
-}
-
-// --- Deck construction ------------------------------------------------------
-
-static void add_repeated(std::vector<Card>& deck, const Card& card, int copies) {
-    for (int i = 0; i < copies; ++i) deck.push_back(card);
-}
-
-static void fill_deck(std::vector<Card>& deck) {
-    deck.clear();
-
-    for (const auto& entry : cards::default_decklist()) {
-        const Card* card = entry.first;
-        if (card) {
-            add_repeated(deck, *card, entry.second);
         }
     }
-
-    shuffle_deck(deck);
+    return snap;
 }
 
-static void apply_field_effect_cards(BattleState& st, BattleSide side) {
-    SideState& ss = get_side_state(st, side);
-    std::vector<Card> remaining;
-    for (Card& c : ss.deck) {
-        if (c.kind == CardKind::FIELD_EFFECT && c.effect) {
-            Card copy = c;
-            apply_card_effect(st, side, copy, -1, -1);
-        } else {
-            remaining.push_back(c);
+// Debris for ship hits and for cards cleared off the field since the snapshot
+static void emit_resolution_effects(const BoardSnapshot& before, const BattleState& st) {
+    int ship_damage[2] = {0, 0};
+    if (st.events) sum_ship_damage(*st.events, before.event_seq, ship_damage);
+    for (int s = 0; s < 2; ++s) {
+        BattleSide bside = (s == 0) ? BattleSide::PLAYER : BattleSide::OPPONENT;
+        const SideState& side = get_side_state(st, bside);
+        emit_ship_hit(bside, ship_damage[s]);
+        const ImVec2 (&centers)[2][6] = (bside == BattleSide::PLAYER) ? g_player_slot_centers : g_opponent_slot_centers;
+        for (int r = 0; r < 2; ++r) {
+            for (int c = 0; c < 6; ++c) {
+                if (before.occupied[s][r][c] && side.field[r][c].empty()) {
+                    emit_battle_burst(centers[r][c], 160, 220.0f, 1.0f, 0.8f, 0.8f, 0.85f);
+                }
+            }
         }
     }
-    ss.deck = std::move(remaining);
-    shuffle_deck(ss.deck);
 }
 
-static void apply_immediate_effect_queues(BattleState& st) {
-    auto& p_queue = st.player.immediate_queue;
-    auto& o_queue = st.opponent.immediate_queue;
-    while (!p_queue.empty() || !o_queue.empty()) {
-        std::vector<BattleSide> options;
-        if (!p_queue.empty()) options.push_back(BattleSide::PLAYER);
-        if (!o_queue.empty()) options.push_back(BattleSide::OPPONENT);
-
-        BattleSide chosen = options.size() == 1
-            ? options[0]
-            : options[std::uniform_int_distribution<int>(0, static_cast<int>(options.size()) - 1)(battle_rng())];
-
-        auto& queue = (chosen == BattleSide::PLAYER) ? p_queue : o_queue;
-        Card card = queue.front();
-        queue.erase(queue.begin());
-        apply_card_effect(st, chosen, card, -1, -1);
-        if (st.player.hp <= 0 || st.opponent.hp <= 0) break;
-    }
-}
+static constexpr float k_anim_wait = 1.0f;
+static constexpr float k_anim_bolt_time = 0.35f;
+static constexpr float k_anim_post_wait = 1.0f;
+static constexpr float k_anim_step_time = k_anim_bolt_time + k_anim_post_wait;
 
 static bool process_battle_events() {
     SDL_Event event;
@@ -489,21 +346,22 @@ static void begin_battle_frame() {
 }
 
 static void render_hp_bars() {
-    ImGui::Text("Opponent HP: %d (DMG x%.2f)", g_battle.opponent.hp, g_battle.opponent.damage_multiplier);
-    if (g_battle.opponent.ship_last_damage > 0) {
+    const BattleMarkers& markers = battle_markers();
+    ImGui::Text("Opponent HP: %d (DMG x%.2f)", g_battle.state.opponent.hp, g_battle.state.opponent.damage_multiplier);
+    if (markers.ship_damage[1] > 0) {
         ImGui::SameLine();
-        ImGui::TextColored(ImVec4(0.9f, 0.2f, 0.2f, 1.0f), "-%d", g_battle.opponent.ship_last_damage);
-    } else if (g_battle.opponent.ship_last_heal > 0) {
+        ImGui::TextColored(ImVec4(0.9f, 0.2f, 0.2f, 1.0f), "-%d", markers.ship_damage[1]);
+    } else if (markers.ship_heal[1] > 0) {
         ImGui::SameLine();
-        ImGui::TextColored(ImVec4(0.2f, 0.8f, 0.3f, 1.0f), "+%d", g_battle.opponent.ship_last_heal);
+        ImGui::TextColored(ImVec4(0.2f, 0.8f, 0.3f, 1.0f), "+%d", markers.ship_heal[1]);
     }
-    ImGui::Text("Player HP: %d (DMG x%.2f)", g_battle.player.hp, g_battle.player.damage_multiplier);
-    if (g_battle.player.ship_last_damage > 0) {
+    ImGui::Text("Player HP: %d (DMG x%.2f)", g_battle.state.player.hp, g_battle.state.player.damage_multiplier);
+    if (markers.ship_damage[0] > 0) {
         ImGui::SameLine();
-        ImGui::TextColored(ImVec4(0.9f, 0.2f, 0.2f, 1.0f), "-%d", g_battle.player.ship_last_damage);
-    } else if (g_battle.player.ship_last_heal > 0) {
+        ImGui::TextColored(ImVec4(0.9f, 0.2f, 0.2f, 1.0f), "-%d", markers.ship_damage[0]);
+    } else if (markers.ship_heal[0] > 0) {
         ImGui::SameLine();
-        ImGui::TextColored(ImVec4(0.2f, 0.8f, 0.3f, 1.0f), "+%d", g_battle.player.ship_last_heal);
+        ImGui::TextColored(ImVec4(0.2f, 0.8f, 0.3f, 1.0f), "+%d", markers.ship_heal[0]);
     }
     ImGui::Separator();
 }
@@ -516,40 +374,44 @@ static void render_opponent_field() {
     if (offset < 0) offset = 0;
     if (offset > 0) ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
     ImGui::TextUnformatted(label);
-    SideState& opponent = g_battle.opponent;
+    SideState& opponent = g_battle.state.opponent;
+    const BattleMarkers& markers = battle_markers();
     if (ImGui::BeginTable("OpponentField", 6)) {
         for (int r = 0; r < 2; r++) {
             ImGui::TableNextRow();
             for (int c = 0; c < 6; c++) {
                 ImGui::TableSetColumnIndex(c);
-                Card& card = opponent.field[r][c][0];
+                ImGui::PushID(r * 6 + c);
+                Card& card = opponent.field[r][c];
                 if (card.hp > 0) {
-                    push_card_kind_colors(card.kind);
-                    ImGui::Button((card.name + "\nHP:" + std::to_string(card.hp) + "\nDMG:" + std::to_string(card.dmg)).c_str(), ImVec2(96, 100));
+                    const CardDef& def = card.def();
+                    push_card_kind_colors(def.kind);
+                    ImGui::Button(slot_label(g_opponent_slot_labels[r][c], card), ImVec2(96, 100));
                     pop_card_kind_colors();
                     if (ImGui::IsItemHovered()) {
                         ImGui::BeginTooltip();
-                        ImGui::Text("%s", card.name.c_str());
-                        ImGui::Text("Type: %s", card_kind_label(card.kind));
+                        ImGui::Text("%s", def.name);
+                        ImGui::Text("Type: %s", card_kind_label(def.kind));
                         ImGui::Text("HP: %d / %d", card.hp, card.max_hp);
                         ImGui::Text("DMG: %d", card.dmg);
-                        if (card.effect_description) {
+                        if (def.effect_description) {
                             ImGui::Separator();
-                            ImGui::TextWrapped("%s", card.effect_description->c_str());
+                            ImGui::TextWrapped("%s", def.effect_description);
                         }
                         ImGui::EndTooltip();
                     }
                 } else {
                     ImGui::Button("Empty", ImVec2(96, 100));
                 }
-                draw_damage_marker(opponent.slot_last_damage[r][c]);
-                draw_heal_marker(opponent.slot_last_heal[r][c]);
+                draw_damage_marker(markers.slot_damage[1][r][c]);
+                draw_heal_marker(markers.slot_heal[1][r][c]);
                 ImVec2 rect_min = ImGui::GetItemRectMin();
                 ImVec2 rect_max = ImGui::GetItemRectMax();
                 g_opponent_slot_centers[r][c] = ImVec2(
                     (rect_min.x + rect_max.x) * 0.5f,
                     (rect_min.y + rect_max.y) * 0.5f
                 );
+                ImGui::PopID();
             }
         }
         ImGui::EndTable();
@@ -569,53 +431,58 @@ static void render_player_field() {
     if (offset < 0) offset = 0;
     if (offset > 0) ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
     ImGui::TextUnformatted(label);
-    SideState& player = g_battle.player;
+    SideState& player = g_battle.state.player;
+    const BattleMarkers& markers = battle_markers();
     if (ImGui::BeginTable("PlayerField", 6)) {
         for (int r = 0; r < 2; r++) {
             ImGui::TableNextRow();
             for (int c = 0; c < 6; c++) {
                 ImGui::TableSetColumnIndex(c);
-                Card& card = player.field[r][c][0];
+                ImGui::PushID(r * 6 + c);
+                Card& card = player.field[r][c];
                 if (card.hp > 0) {
-                    push_card_kind_colors(card.kind);
-                    ImGui::Button((card.name + "\nHP:" + std::to_string(card.hp) + "\nDMG:" + std::to_string(card.dmg) + "##p" + std::to_string(r) + std::to_string(c)).c_str(), ImVec2(96, 100));
+                    const CardDef& def = card.def();
+                    push_card_kind_colors(def.kind);
+                    ImGui::Button(slot_label(g_player_slot_labels[r][c], card), ImVec2(96, 100));
                     pop_card_kind_colors();
                     if (ImGui::IsItemHovered()) {
                         ImGui::BeginTooltip();
-                        ImGui::Text("%s", card.name.c_str());
-                        ImGui::Text("Type: %s", card_kind_label(card.kind));
+                        ImGui::Text("%s", def.name);
+                        ImGui::Text("Type: %s", card_kind_label(def.kind));
                         ImGui::Text("HP: %d / %d", card.hp, card.max_hp);
                         ImGui::Text("DMG: %d", card.dmg);
-                        if (card.effect_description) {
+                        if (def.effect_description) {
                             ImGui::Separator();
-                            ImGui::TextWrapped("%s", card.effect_description->c_str());
+                            ImGui::TextWrapped("%s", def.effect_description);
                         }
                         ImGui::EndTooltip();
                     }
                 } else {
                     if (g_battle.selected_card_hand_idx != -1 && !g_battle.battle_animating) {
-                        Card& hand_card = player.hand[g_battle.selected_card_hand_idx];
-                        bool placeable = hand_card.kind != CardKind::IMMEDIATE && hand_card.hp > 0;
+                        const CardDef& hand_card = card_def(player.hand[g_battle.selected_card_hand_idx]);
+                        PlayAction place{g_battle.selected_card_hand_idx, r, c};
+                        bool placeable = hand_card.kind != CardKind::IMMEDIATE && can_play_card(g_battle.state, BattleSide::PLAYER, place);
                         if (!placeable) ImGui::BeginDisabled();
-                        if (ImGui::Button(("Place Here##p" + std::to_string(r) + std::to_string(c)).c_str(), ImVec2(96, 100))) {
-                            player.field[r][c][0] = player.hand[g_battle.selected_card_hand_idx];
-                            player.hand.erase(player.hand.begin() + g_battle.selected_card_hand_idx);
+                        if (ImGui::Button("Place Here", ImVec2(96, 100))) {
+                            player_play(place);
                             g_battle.selected_card_hand_idx = -1;
-                            append_log(std::string("Player placed card ") + player.field[r][c][0].name + " at row " + std::to_string(r) + " col " + std::to_string(c));
+                        } else if (placeable && ImGui::IsItemHovered()) {
+                            render_placement_preview(place);
                         }
                         if (!placeable) ImGui::EndDisabled();
                     } else {
-                        ImGui::Button(("Empty##p" + std::to_string(r) + std::to_string(c)).c_str(), ImVec2(96, 100));
+                        ImGui::Button("Empty", ImVec2(96, 100));
                     }
                 }
-                draw_damage_marker(player.slot_last_damage[r][c]);
-                draw_heal_marker(player.slot_last_heal[r][c]);
+                draw_damage_marker(markers.slot_damage[0][r][c]);
+                draw_heal_marker(markers.slot_heal[0][r][c]);
                 ImVec2 rect_min = ImGui::GetItemRectMin();
                 ImVec2 rect_max = ImGui::GetItemRectMax();
                 g_player_slot_centers[r][c] = ImVec2(
                     (rect_min.x + rect_max.x) * 0.5f,
                     (rect_min.y + rect_max.y) * 0.5f
                 );
+                ImGui::PopID();
             }
         }
         ImGui::EndTable();
@@ -629,15 +496,15 @@ static void render_player_field() {
 
 static void render_player_hand() {
     ImGui::Text("Your Hand");
-    auto& hand = g_battle.player.hand;
-    for (size_t i = 0; i < hand.size(); i++) {
-        Card& card = hand[i];
+    auto& hand = g_battle.state.player.hand;
+    for (int i = 0; i < hand.size(); i++) {
+        const CardDef& card = card_def(hand[i]);
         bool selected = (g_battle.selected_card_hand_idx == (int)i);
         push_card_kind_colors(card.kind);
         if (selected) ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.8f, 0.8f, 0.2f, 1.0f));
 
-        std::string label = card.name + "##h" + std::to_string(i);
-        if (ImGui::Button(label.c_str(), ImVec2(120, 150))) {
+        ImGui::PushID((int)i);
+        if (ImGui::Button(card.name, ImVec2(120, 150))) {
             if (selected) g_battle.selected_card_hand_idx = -1;
             else g_battle.selected_card_hand_idx = (int)i;
         }
@@ -645,93 +512,126 @@ static void render_player_hand() {
         pop_card_kind_colors();
         if (ImGui::IsItemHovered()) {
             ImGui::BeginTooltip();
-            ImGui::Text("%s", card.name.c_str());
+            ImGui::Text("%s", card.name);
             ImGui::Text("Type: %s", card_kind_label(card.kind));
-            ImGui::Text("HP: %d / %d", card.hp, card.max_hp);
+            ImGui::Text("HP: %d / %d", card.hp, card.hp);
             ImGui::Text("DMG: %d", card.dmg);
             if (card.effect_description) {
                 ImGui::Separator();
-                ImGui::TextWrapped("%s", card.effect_description->c_str());
+                ImGui::TextWrapped("%s", card.effect_description);
             }
             ImGui::EndTooltip();
         }
 
         if (selected && card.kind == CardKind::IMMEDIATE && !g_battle.battle_animating) {
             ImGui::SameLine();
-            if (ImGui::Button(("Activate##" + std::to_string(i)).c_str(), ImVec2(90, 30))) {
-                g_battle.player.immediate_queue.push_back(card);
-                g_battle.player.hand.erase(g_battle.player.hand.begin() + (int)i);
+            if (ImGui::Button("Activate", ImVec2(90, 30))) {
+                player_play(PlayAction{i, -1, -1});
                 g_battle.selected_card_hand_idx = -1;
-                append_log(std::string("Player queued immediate card ") + card.name);
                 // reset loop after erase
                 i--;
             }
         }
 
         if (selected) ImGui::PopStyleColor();
+        ImGui::PopID();
         ImGui::SameLine();
     }
     ImGui::NewLine();
 }
 
+// Adds the planned turn to the replay, along with the hash of the state
+// once it resolves; the animation only catches up with that later
+static void record_turn(const BattleState& st, TurnInputs opponent) {
+    g_battle.replay.turns.push_back({std::move(g_battle.pending_inputs), std::move(opponent)});
+    g_battle.pending_inputs.clear();
+    BattleState resolved = st;
+    resolved.events = nullptr;
+    if (begin_resolution(resolved)) {
+        for (int step = 0; step < BATTLE_ATTACK_STEPS; ++step) resolve_attack_step(resolved, step);
+    }
+    g_battle.replay.final_hash = battle_state_hash(resolved);
+}
+
+static void end_turn(double now) {
+    BattleState& st = g_battle.state;
+    // The opponent commits its moves alongside the player's, planned
+    // from the start of the turn without seeing the player's
+    TurnInputs opponent;
+    for (const PlayAction& action : mcts_ponder_finish(g_opponent_ai, st, BattleSide::OPPONENT)) {
+        if (play_card(st, BattleSide::OPPONENT, action)) opponent.push_back(action);
+    }
+    record_turn(st, std::move(opponent));
+    BoardSnapshot before = snapshot_board(st);
+    // Markers restart with the resolution
+    g_battle.marker_start = g_battle.events.total;
+    bool attacks = begin_resolution(st);
+    if (attacks && (g_battle_turbo || g_battle_auto)) {
+        for (int step = 0; step < BATTLE_ATTACK_STEPS; ++step) resolve_attack_step(st, step);
+        attacks = false;
+    }
+    // Nothing of the board is drawn while auto-battling
+    if (!g_battle_auto) emit_resolution_effects(before, st);
+    if (attacks) {
+        g_battle.battle_animating = true;
+        g_battle.anim_initial_wait = true;
+        g_battle.anim_step_index = -1;
+        g_battle.anim_step_start_time = now;
+        g_battle.anim_damage_applied = false;
+    } else {
+        start_opponent_search(st);
+    }
+}
+
 static void handle_end_turn_button(double now) {
     bool end_turn_disabled = g_battle.battle_animating;
     if (end_turn_disabled) ImGui::BeginDisabled();
-    if (ImGui::Button("End Turn", ImVec2(120, 40))) {
-        auto& player = g_battle.player;
-        auto& opponent = g_battle.opponent;
-        g_battle.skip_attack_phase = false;
-        for(int i=0; i<2; i++) {
-            if(!player.deck.empty()) {
-                player.hand.push_back(player.deck.back());
-                player.deck.pop_back();
-            }
-            if(!opponent.deck.empty()) {
-                opponent.hand.push_back(opponent.deck.back());
-                opponent.deck.pop_back();
-            }
-        }
-        // Move opponent immediate cards to queue immediately after draw
-        for (auto it = opponent.hand.begin(); it != opponent.hand.end();) {
-            if (it->kind == CardKind::IMMEDIATE) {
-                opponent.immediate_queue.push_back(*it);
-                it = opponent.hand.erase(it);
-            } else {
-                ++it;
-            }
-        }
+    if (ImGui::Button("End Turn", ImVec2(120, 40))) end_turn(now);
+    if (end_turn_disabled) ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::Checkbox("Turbo", &g_battle_turbo);
+    ImGui::SameLine();
+    ImGui::Checkbox("Auto-battle", &g_battle_auto);
+}
 
-        for(auto it = opponent.hand.begin(); it != opponent.hand.end(); ) {
-            bool placed = false;
-            for(int r=0; r<2 && !placed; r++) {
-                for(int c=0; c<6 && !placed; c++) {
-                    if (opponent.field[r][c][0].hp <= 0 && it->kind != CardKind::IMMEDIATE) {
-                        opponent.field[r][c][0] = *it;
-                        it = opponent.hand.erase(it);
-                        placed = true;
-                        append_log(std::string("Opponent placed card ") + opponent.field[r][c][0].name + " at row " + std::to_string(r) + " col " + std::to_string(c));
-                    }
-                }
-            }
-            if(!placed) ++it;
-        }
+// Plays the player's turn with the built-in AI; the screen only shows
+// progress until the outcome window
+static void run_auto_battle(double now) {
+    if (!g_battle_auto || battle_over(g_battle.state) || g_battle.battle_animating) return;
+    request_redraw();
+    // The opponent still gets its full search time each turn
+    if ((now - g_battle.search_started) * 1000.0 < MctsConfig{}.budget_ms) return;
+    for (const PlayAction& action : plan_turn(g_battle.state, BattleSide::PLAYER)) player_play(action);
+    g_battle.selected_card_hand_idx = -1;
+    end_turn(now);
+}
 
-        reset_damage_tracking(g_battle);
-        apply_immediate_effect_queues(g_battle);
-        cleanup_destroyed_cards();
-        if (g_battle.player.hp > 0 && g_battle.opponent.hp > 0) {
-            g_battle.battle_animating = true;
-            g_battle.anim_initial_wait = true;
-            g_battle.anim_step_index = -1;
-            g_battle.anim_step_start_time = now;
-            g_battle.anim_damage_applied = false;
-        }
-    }
-    if (end_turn_disabled) ImGui::EndDisabled();
+static void render_auto_battle_status() {
+    ImGui::Text("Auto-battle: turn %d", g_battle.state.turn);
+    ImGui::Text("Opponent HP: %d", g_battle.state.opponent.hp);
+    ImGui::Text("Player HP: %d", g_battle.state.player.hp);
+    ImGui::Checkbox("Auto-battle", &g_battle_auto);
 }
 
+static void emit_bolt_impacts(int step);
+
 static void update_battle_animation(double now) {
     if (!g_battle.battle_animating) return;
+    request_redraw();
+
+    // Turbo switched on mid-turn: the remaining steps resolve at once
+    if (g_battle_turbo || g_battle_auto) {
+        int step = g_battle.anim_initial_wait ? 0 : g_battle.anim_step_index + (g_battle.anim_damage_applied ? 1 : 0);
+        BoardSnapshot before = snapshot_board(g_battle.state);
+        for (; step < BATTLE_ATTACK_STEPS; ++step) resolve_attack_step(g_battle.state, step);
+        emit_resolution_effects(before, g_battle.state);
+        g_battle.battle_animating = false;
+        g_battle.anim_initial_wait = false;
+        g_battle.anim_step_index = -1;
+        g_battle.anim_damage_applied = false;
+        start_opponent_search(g_battle.state);
+        return;
+    }
 
     if (g_battle.anim_initial_wait) {
         if (now - g_battle.anim_step_start_time >= k_anim_wait) {
@@ -743,12 +643,14 @@ static void update_battle_animation(double now) {
         return;
     }
 
-    if (g_battle.anim_step_index < 0 || g_battle.anim_step_index >= 3) return;
+    if (g_battle.anim_step_index < 0 || g_battle.anim_step_index >= BATTLE_ATTACK_STEPS) return;
 
     double step_elapsed = now - g_battle.anim_step_start_time;
     if (!g_battle.anim_damage_applied && step_elapsed >= k_anim_bolt_time) {
-        apply_attacks_for_column(k_attack_phase_cols[g_battle.anim_step_index][0]);
-        apply_attacks_for_column(k_attack_phase_cols[g_battle.anim_step_index][1]);
+        emit_bolt_impacts(g_battle.anim_step_index);
+        BoardSnapshot before = snapshot_board(g_battle.state);
+        resolve_attack_step(g_battle.state, g_battle.anim_step_index);
+        emit_resolution_effects(before, g_battle.state);
         g_battle.anim_damage_applied = true;
     }
     if (step_elapsed >= k_anim_step_time) {
@@ -756,19 +658,20 @@ static void update_battle_animation(double now) {
         g_battle.anim_step_start_time = now;
         g_battle.anim_damage_applied = false;
         g_battle.anim_initial_wait = false;
-        if (g_battle.anim_step_index >= 3) {
+        if (g_battle.anim_step_index >= BATTLE_ATTACK_STEPS) {
             g_battle.battle_animating = false;
             g_battle.anim_initial_wait = false;
             g_battle.anim_step_index = -1;
             g_battle.anim_damage_applied = false;
+            start_opponent_search(g_battle.state);
         }
     }
 }
 
 struct BoltRenderContext {
     BattleSide side;
-    const std::vector<Card> (&field)[2][6];
-    const std::vector<Card> (&target_field)[2][6];
+    const SideState& attacker;
+    const SideState& target;
     const ImVec2 (&slot_centers)[2][6];
     const ImVec2 (&target_slot_centers)[2][6];
     const ImVec2& ship_pos;
@@ -777,45 +680,44 @@ struct BoltRenderContext {
     ImU32 color;
 };
 
-static void render_bolts_for_side(int column, ImDrawList* draw_list, const BoltRenderContext& ctx) {
+// Start and end of the bolt fired from a column this step, if any
+static bool find_bolt(int column, const BoltRenderContext& ctx, ImVec2& from, ImVec2& to) {
     for (int r = 0; r < 2; ++r) {
-        const Card& card = ctx.field[r][column][0];
-        if (card.hp <= 0 || card.dmg <= 0) continue;
+        if (!slot_live(ctx.attacker.live, r, column) || ctx.attacker.field[r][column].dmg <= 0) continue;
 
-        int target_col = find_target_column(ctx.target_field, column);
-        bool can_hit_ship = (target_col < 0) && center_columns_clear(ctx.target_field, column);
+        int target_col = find_target_column(ctx.target.live, column);
+        bool can_hit_ship = (target_col < 0) && center_columns_clear(ctx.target.live, column);
         if (target_col < 0 && !can_hit_ship) continue;
 
-        ImVec2 from = ctx.slot_centers[r][column];
+        from = ctx.slot_centers[r][column];
         if (target_col >= 0) {
             from.x += 6.0f * ctx.offset_direction;
         }
 
-        ImVec2 to = ctx.target_ship_pos;
+        to = ctx.target_ship_pos;
         if (target_col >= 0) {
             int preferred_row = (ctx.side == BattleSide::PLAYER) ? 1 : 0;
             int fallback_row = preferred_row ^ 1;
-            int target_row = (ctx.target_field[preferred_row][target_col][0].hp > 0) ? preferred_row : fallback_row;
+            int target_row = slot_live(ctx.target.live, preferred_row, target_col) ? preferred_row : fallback_row;
             to = ctx.target_slot_centers[target_row][target_col];
         }
+        return true;
+    }
+    return false;
+}
 
+static void render_bolts_for_side(int column, ImDrawList* draw_list, const BoltRenderContext& ctx) {
+    ImVec2 from, to;
+    if (find_bolt(column, ctx, from, to)) {
         draw_list->AddLine(from, to, ctx.color, 3.0f);
-        break;
     }
 }
 
-static void render_battle_bolts(double now) {
-    if (!g_battle.battle_animating || g_battle.anim_initial_wait) return;
-    if (g_battle.anim_step_index < 0 || g_battle.anim_step_index >= 3) return;
-
-    double step_elapsed = now - g_battle.anim_step_start_time;
-    if (step_elapsed > k_anim_bolt_time) return;
-
-    ImDrawList* draw_list = ImGui::GetWindowDrawList();
-    BoltRenderContext player_ctx{
+static BoltRenderContext player_bolt_context() {
+    return BoltRenderContext{
         BattleSide::PLAYER,
-        g_battle.player.field,
-        g_battle.opponent.field,
+        g_battle.state.player,
+        g_battle.state.opponent,
         g_player_slot_centers,
         g_opponent_slot_centers,
         g_player_ship_pos,
@@ -823,10 +725,13 @@ static void render_battle_bolts(double now) {
         -1.0f,
         IM_COL32(90, 220, 120, 255)
     };
-    BoltRenderContext opponent_ctx{
+}
+
+static BoltRenderContext opponent_bolt_context() {
+    return BoltRenderContext{
         BattleSide::OPPONENT,
-        g_battle.opponent.field,
-        g_battle.player.field,
+        g_battle.state.opponent,
+        g_battle.state.player,
         g_opponent_slot_centers,
         g_player_slot_centers,
         g_opponent_ship_pos,
@@ -834,20 +739,68 @@ static void render_battle_bolts(double now) {
         1.0f,
         IM_COL32(220, 90, 90, 255)
     };
+}
 
+// Sparks where this step's bolts land; call before the damage is applied
+static void emit_bolt_impacts(int step) {
+    BoltRenderContext player_ctx = player_bolt_context();
+    BoltRenderContext opponent_ctx = opponent_bolt_context();
     for (int i = 0; i < 2; ++i) {
-        int c = k_attack_phase_cols[g_battle.anim_step_index][i];
+        int c = BATTLE_ATTACK_COLS[step][i];
+        ImVec2 from, to;
+        if (find_bolt(c, player_ctx, from, to)) emit_battle_burst(to, 60, 180.0f, 0.5f, 0.35f, 0.86f, 0.47f);
+        if (find_bolt(c, opponent_ctx, from, to)) emit_battle_burst(to, 60, 180.0f, 0.5f, 0.86f, 0.35f, 0.35f);
+    }
+}
+
+static void render_battle_bolts(double now) {
+    if (!g_battle.battle_animating || g_battle.anim_initial_wait) return;
+    if (g_battle.anim_step_index < 0 || g_battle.anim_step_index >= BATTLE_ATTACK_STEPS) return;
+
+    double step_elapsed = now - g_battle.anim_step_start_time;
+    if (step_elapsed > k_anim_bolt_time) return;
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    BoltRenderContext player_ctx = player_bolt_context();
+    BoltRenderContext opponent_ctx = opponent_bolt_context();
+
+    for (int i = 0; i < 2; ++i) {
+        int c = BATTLE_ATTACK_COLS[g_battle.anim_step_index][i];
         render_bolts_for_side(c, draw_list, player_ctx);
         render_bolts_for_side(c, draw_list, opponent_ctx);
     }
 }
 
-static void render_battle_outcome_window() {
-    if (g_battle.player.hp > 0 && g_battle.opponent.hp > 0) return;
+// Runs inside ImGui's renderer, between the window's own draw commands
+static void draw_battle_particles(const ImDrawList*, const ImDrawCmd*) {
+    ImGuiIO& io = ImGui::GetIO();
+    // Pixels (y down) to clip space
+    float transform[9];
+    make_transform(transform, -1.0f, 1.0f, 2.0f / io.DisplaySize.x, -2.0f / io.DisplaySize.y);
+    glDisable(GL_SCISSOR_TEST);
+    g_battle_particles.draw(particleProgram, transform, false, 5.0f);
+    flush_draw_commands();
+}
 
-    bool player_won = g_battle.player.hp > 0 && g_battle.opponent.hp <= 0;
-    if (player_won && !g_battle.reward_added && g_battle.reward_options.empty()) {
-        g_battle.reward_options = pick_reward_cards(g_battle.difficulty, 3);
+static void render_battle_particles() {
+    g_battle_particles.update(ImGui::GetIO().DeltaTime);
+    if (g_battle_particles.count() == 0) return;
+    request_redraw();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    draw_list->AddCallback(draw_battle_particles, nullptr);
+    // Hand ImGui's own GL state back for the rest of the list
+    draw_list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+static void render_battle_outcome_window() {
+    if (g_battle.state.player.hp > 0 && g_battle.state.opponent.hp > 0) return;
+
+    bool player_won = g_battle.state.player.hp > 0 && g_battle.state.opponent.hp <= 0;
+    bool deck_full = g_battle.player_deck_ref && g_battle.player_deck_ref->size() >= BATTLE_DECK_CAPACITY;
+    if (player_won && !deck_full && !g_battle.reward_added && g_battle.reward_options.empty()) {
+        BattleRng reward_rng;
+        reward_rng.seed(g_battle.seed ^ 0x5851F42D4C957F2Dull);
+        g_battle.reward_options = pick_reward_cards(g_battle.difficulty, 3, reward_rng);
         if (g_battle.reward_options.empty()) {
             g_battle.reward_added = true;
         }
@@ -855,41 +808,44 @@ static void render_battle_outcome_window() {
 
     ImGui::SetNextWindowPos(ImVec2(g_state.screen_width / 2.0f - 100.0f, g_state.screen_height / 2.0f - 50.0f), ImGuiCond_Always);
     ImGui::Begin("Battle Over", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove);
-    if (g_battle.player.hp <= 0) ImGui::Text("DEFEAT...");
+    if (g_battle.state.player.hp <= 0) ImGui::Text("DEFEAT...");
     else {
         ImGui::Text("VICTORY!");
-        if (!g_battle.reward_added) {
+        if (deck_full && !g_battle.reward_card) {
+            ImGui::Separator();
+            ImGui::Text("Your deck is full (%d cards), no reward this time.", BATTLE_DECK_CAPACITY);
+        } else if (!g_battle.reward_added) {
             ImGui::Separator();
             ImGui::Text("Choose your reward:");
             if (g_battle.reward_options.empty()) {
                 ImGui::Text("No rewards available.");
             } else {
                 for (size_t i = 0; i < g_battle.reward_options.size(); ++i) {
-                    const Card& c = g_battle.reward_options[i];
+                    const CardDef& c = card_def(g_battle.reward_options[i]);
                     ImGui::Separator();
-                    ImGui::Text("%s", c.name.c_str());
-                    ImGui::Text("Cost: %d | HP: %d | DMG: %d", c.cost, c.max_hp, c.base_dmg);
+                    ImGui::Text("%s", c.name);
+                    ImGui::Text("Cost: %d | HP: %d | DMG: %d", c.cost, c.hp, c.dmg);
                     if (c.effect_description) {
-                        ImGui::TextWrapped("Effect: %s", c.effect_description->c_str());
+                        ImGui::TextWrapped("Effect: %s", c.effect_description);
                     }
                     if (ImGui::Button(("Choose##reward" + std::to_string(i)).c_str(), ImVec2(200, 35))) {
-                        g_battle.reward_card = c;
-                        g_battle.player.deck.push_back(c);
+                        g_battle.reward_card = c.id;
+                        g_battle.state.player.deck.push_back(c.id);
                         if (g_battle.player_deck_ref) {
-                            g_battle.player_deck_ref->push_back(c);
+                            g_battle.player_deck_ref->push_back(c.id);
                         }
-                        append_log(std::string("Reward gained: ") + c.name);
+                        log_event(BattleEventKind::REWARD_GAINED, c.id);
                         g_battle.reward_added = true;
                     }
                 }
             }
         } else if (g_battle.reward_card) {
-            const Card& c = *g_battle.reward_card;
+            const CardDef& c = card_def(*g_battle.reward_card);
             ImGui::Separator();
-            ImGui::Text("Reward: %s", c.name.c_str());
-            ImGui::Text("Cost: %d | HP: %d | DMG: %d", c.cost, c.max_hp, c.base_dmg);
+            ImGui::Text("Reward: %s", c.name);
+            ImGui::Text("Cost: %d | HP: %d | DMG: %d", c.cost, c.hp, c.dmg);
             if (c.effect_description) {
-                ImGui::TextWrapped("Effect: %s", c.effect_description->c_str());
+                ImGui::TextWrapped("Effect: %s", c.effect_description);
             }
         }
     }
@@ -904,6 +860,12 @@ static void render_debug_controls() {
     if (ImGui::Button("Leave Battle (Debug)")) {
         set_mode(GameMode::OVERWORLD);
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Copy Replay")) {
+        // Turns played so far; verify with replay_check
+        ImGui::SetClipboardText(replay_to_text(g_battle.replay).c_str());
+        log_event(BattleEventKind::REPLAY_COPIED, CARD_NONE, (int)g_battle.replay.turns.size());
+    }
 }
 
 static void end_battle_frame() {
@@ -916,114 +878,130 @@ static void end_battle_frame() {
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
+// Sequence numbers of the logged events that have a line of text, so the
+// clipper can find visible rows without formatting the rest
+static std::vector<uint32_t> g_log_rows;
+static uint32_t g_log_indexed = 0;
+
+static void reset_action_log() {
+    g_log_rows.clear();
+    g_log_indexed = 0;
+}
+
+static void index_action_log() {
+    const BattleEventLog& events = g_battle.events;
+    for (uint32_t seq = std::max(g_log_indexed, events.first()); seq < events.total; ++seq) {
+        BattleEventKind kind = events.at(seq).kind;
+        if (kind != BattleEventKind::SLOT_DAMAGED && kind != BattleEventKind::SLOT_MENDED) g_log_rows.push_back(seq);
+    }
+    g_log_indexed = events.total;
+    // Rows the ring has overwritten go in batches, not one per frame
+    size_t stale = 0;
+    while (stale < g_log_rows.size() && g_log_rows[stale] < events.first()) stale++;
+    if (stale >= 64 || stale == g_log_rows.size()) g_log_rows.erase(g_log_rows.begin(), g_log_rows.begin() + stale);
+}
+
 static void render_action_log() {
     ImGui::Separator();
     ImGui::Text("Action Log");
-    ImGui::BeginChild("ActionLog", ImVec2(0, 200), true);
+    ImGui::BeginChild("ActionLog", ImVec2(0, 200), true, ImGuiWindowFlags_HorizontalScrollbar);
     static size_t last_log_count = 0;
     float prev_scroll = ImGui::GetScrollY();
     float prev_max = ImGui::GetScrollMaxY();
     bool was_at_bottom = prev_scroll >= prev_max - 5.0f;
 
-    for (const auto& line : g_battle.action_log) {
-        ImGui::TextWrapped("%s", line.c_str());
+    index_action_log();
+    const BattleEventLog& events = g_battle.events;
+    size_t skip = 0;
+    while (skip < g_log_rows.size() && g_log_rows[skip] < events.first()) skip++;
+    size_t rows = g_log_rows.size() - skip;
+
+    // One unwrapped line per entry, so only the visible ones are formatted
+    ImGuiListClipper clipper;
+    clipper.Begin((int)rows);
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            ImGui::TextUnformatted(format_battle_event(events.at(g_log_rows[skip + i])).c_str());
+        }
     }
+    clipper.End();
     ImGui::Dummy(ImVec2(0, ImGui::GetTextLineHeight())); // bottom padding so last line fully visible
-    if ((was_at_bottom || last_log_count == 0) && !g_battle.action_log.empty()) {
+    if ((was_at_bottom || last_log_count == 0) && rows > 0) {
         ImGui::SetScrollHereY(1.0f);
     }
-    last_log_count = g_battle.action_log.size();
+    last_log_count = rows;
     ImGui::EndChild();
 }
 
-static void clear_side_field(SideState& side) {
-    for (int r = 0; r < 2; ++r) {
-        for (int c = 0; c < 6; ++c) {
-            side.field[r][c].clear();
-            side.field[r][c].push_back(make_empty_card());
-        }
-    }
-}
-
-static void initial_draw(std::vector<Card>& deck, std::vector<Card>& hand) {
-    for (int i = 0; i < 5; ++i) {
-        if (deck.empty()) break;
-        hand.push_back(deck.back());
-        deck.pop_back();
-    }
-}
-
-void init_battle(BattleState& state, std::vector<Card>& player_deck, int difficulty) {
-    state.player = SideState{};
-    state.opponent = SideState{};
-    state.action_log.clear();
-    state.reward_card.reset();
-    state.reward_options.clear();
-    state.reward_added = false;
-    state.player_deck_ref = &player_deck;
-    state.difficulty = difficulty;
-    append_log("Battle started");
-
-    clear_side_field(state.player);
-    clear_side_field(state.opponent);
+void init_battle(BattleSession& session, std::vector<CardId>& player_deck, int difficulty, uint64_t seed) {
+    session.events.clear();
+    reset_action_log();
+    g_markers_total = UINT32_MAX;
+    g_preview.event_total = UINT32_MAX;
+    session.reward_card.reset();
+    session.reward_options.clear();
+    session.reward_added = false;
+    session.player_deck_ref = &player_deck;
+    session.difficulty = difficulty;
+    g_battle_particles.clear();
+    session.state.events = &session.events;
+    battle_event(session.state, BattleEvent{BattleEventKind::BATTLE_STARTED});
 
     // Player uses their own deck (assumed non-empty and pre-assigned)
-    state.player.deck = player_deck;
-    shuffle_deck(state.player.deck);
-
     int opponent_cost_limit = std::max(1, difficulty);
-    state.opponent.deck = cards::generate_deck_with_cost(opponent_cost_limit);
-    shuffle_deck(state.opponent.deck);
-    apply_field_effect_cards(state, BattleSide::PLAYER);
-    apply_field_effect_cards(state, BattleSide::OPPONENT);
-
-    state.player.hand.clear();
-    state.opponent.hand.clear();
-    initial_draw(state.player.deck, state.player.hand);
-    initial_draw(state.opponent.deck, state.opponent.hand);
-    // AI auto-activates immediate cards as soon as they are drawn
-    for (size_t i = 0; i < state.opponent.hand.size();) {
-        if (state.opponent.hand[i].kind == CardKind::IMMEDIATE) {
-            state.opponent.immediate_queue.push_back(state.opponent.hand[i]);
-            state.opponent.hand.erase(state.opponent.hand.begin() + (int)i);
-        } else {
-            ++i;
-        }
-    }
-
-    state.selected_card_hand_idx = -1;
-    state.is_player_turn = true;
-    state.battle_animating = false;
-    state.anim_step_index = -1;
-    state.skip_attack_phase = false;
-    reset_damage_tracking(state);
+    BattleRng deck_rng;
+    deck_rng.seed(seed ^ 0xD1B54A32D192ED03ull);
+    std::vector<CardId> opponent_deck = cards::generate_deck_with_cost(opponent_cost_limit, deck_rng);
+    session.seed = seed;
+    init_battle_state(session.state, player_deck, opponent_deck, seed);
+    session.marker_start = session.events.total;
+    start_replay(session.replay, seed, player_deck, opponent_deck);
+    session.replay.final_hash = battle_state_hash(session.state);
+    session.pending_inputs.clear();
+
+    session.selected_card_hand_idx = -1;
+    session.battle_animating = false;
+    session.anim_step_index = -1;
+    start_opponent_search(session.state);
+}
+
+void start_random_battle(std::vector<CardId>& player_deck, int difficulty) {
+    std::random_device device;
+    uint64_t seed = ((uint64_t)device() << 32) | device();
+    init_battle(g_battle, player_deck, difficulty, seed);
+    set_mode(GameMode::BATTLE);
 }
 
-void start_random_battle(std::vector<Card>& player_deck, int difficulty) {
-    init_battle(g_battle, player_deck, difficulty);
-    set_mode(GameMode::BATTLE);
+void battle_background_work() {
+    mcts_ponder_step(g_opponent_ai, k_ponder_slice_ms);
 }
 
 void battle_loop() {
     const double now = ImGui::GetTime();
     if (!process_battle_events()) return;
 
-    if (is_stalemate(g_battle)) {
-        append_log("Stalemate detected: ending battle.");
+    if (is_stalemate(g_battle.state)) {
+        log_event(BattleEventKind::STALEMATE);
         set_mode(GameMode::OVERWORLD);
         return;
     }
 
+    update_battle_animation(now);
+    run_auto_battle(now);
     begin_battle_frame();
 
-    render_hp_bars();
-    render_opponent_field();
-    render_player_field();
-    render_player_hand();
-    handle_end_turn_button(now);
-    update_battle_animation(now);
-    render_battle_bolts(now);
-    render_action_log();
+    if (g_battle_auto && !battle_over(g_battle.state)) {
+        render_auto_battle_status();
+    } else {
+        render_hp_bars();
+        render_opponent_field();
+        render_player_field();
+        render_player_hand();
+        handle_end_turn_button(now);
+        render_battle_bolts(now);
+        render_battle_particles();
+        render_action_log();
+    }
     render_battle_outcome_window();
     render_debug_controls();
 
@@ -4,75 +4,24 @@
 #include <string>
 #include <vector>
 #include <optional>
-#include <functional>
+#include "battle_sim.h"
+#include "battle_replay.h"
+
+// The battle screen: a BattleState plus what only the UI needs around it
+struct BattleSession {
+    BattleState state;
+    // Decides the opponent's deck, the battle and the rewards
+    uint64_t seed = 0;
+    BattleReplay replay;
+    // The player's moves this turn, added to the replay at End Turn
+    TurnInputs pending_inputs;
 
-enum class CardType {
-    SHIELD,
-    TURRET,
-    DRONE,
-    UTILITY,
-    DEFAULT
-};
-
-enum class BattleSide {
-    PLAYER,
-    OPPONENT
-};
-
-enum class CardKind {
-    NORMAL,
-    SPECIAL,
-    IMMEDIATE,
-    FIELD_EFFECT
-};
-
-struct CardState {
-    int times_used = 0;
-    int cooldown = 0;
-    bool skip_this_turn = false;
-};
-
-using CardEffect = std::function<void(struct BattleState&, BattleSide, int row, int col)>;
-
-struct Card {
-    std::string name;
-    int hp;
-    int max_hp;
-    int dmg;
-    int base_dmg;
-    int cost = 0;
-    CardType type;
-    CardKind kind = CardKind::NORMAL;
-    CardEffect effect;
-    std::optional<std::string> effect_description;
-    CardState state;
-};
-
-struct SideState {
-    int hp = 10000;
-    double damage_multiplier = 1.0;
-    std::vector<Card> deck;
-    std::vector<Card> hand;
-    std::vector<Card> field[2][6];
-    std::vector<Card> immediate_queue;
-    int ship_last_damage = 0;
-    int ship_last_heal = 0;
-    int slot_last_damage[2][6] = {};
-    int slot_last_heal[2][6] = {};
-};
-
-struct BattleState {
-    SideState player;
-    SideState opponent;
-
-    bool is_player_turn = true;
     int difficulty = 1;
     bool battle_animating = false;
-    bool skip_attack_phase = false;
     int selected_card_hand_idx = -1;
-    std::vector<Card>* player_deck_ref = nullptr;
-    std::optional<Card> reward_card;
-    std::vector<Card> reward_options;
+    std::vector<CardId>* player_deck_ref = nullptr;
+    std::optional<CardId> reward_card;
+    std::vector<CardId> reward_options;
     bool reward_added = false;
 
     // Animation state
@@ -80,21 +29,25 @@ struct BattleState {
     double anim_step_start_time = 0.0;
     bool anim_damage_applied = false;
     bool anim_initial_wait = false;
+    // When the opponent began searching this turn (ImGui time)
+    double search_started = 0.0;
 
-    std::vector<std::string> action_log;
+    // What happened, as typed events; the action log formats them when drawn
+    BattleEventLog events;
+    // Damage and heal markers sum the events from here on, i.e. this turn's
+    uint32_t marker_start = 0;
 };
 
-SideState& get_side_state(BattleState& state, BattleSide side);
-const SideState& get_side_state(const BattleState& state, BattleSide side);
-BattleSide opposite_side(BattleSide side);
-void deal_damage_to_all_slots(SideState& side, int amount);
-void heal_all_slots(SideState& side, int amount);
-void deal_damage_to_ship(SideState& side, int dmg);
-void heal_ship(SideState& side, int amount);
-void card_took_damage_trigger(SideState& side, int row, int col, int amount);
+// Battle screen options, kept across battles
+// Resolve each turn at once instead of animating the attack steps
+extern bool g_battle_turbo;
+// Play the player's side with plan_turn until the battle ends
+extern bool g_battle_auto;
 
 void battle_loop();
-void init_battle(BattleState& state, std::vector<Card>& player_deck, int difficulty);
-void start_random_battle(std::vector<Card>& player_deck, int difficulty);
+// Runs every main loop iteration in battle mode, drawn or not
+void battle_background_work();
+void init_battle(BattleSession& session, std::vector<CardId>& player_deck, int difficulty, uint64_t seed);
+void start_random_battle(std::vector<CardId>& player_deck, int difficulty);
 
 #endif
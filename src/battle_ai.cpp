@@ -0,0 +1,349 @@
+#include "battle_ai.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#if BATTLE_AI_THREADS
+#include <atomic>
+#include <thread>
+#endif
+
+using MctsClock = std::chrono::steady_clock;
+
+struct MctsArm {
+    long long visits = 0;
+    double value = 0.0;
+};
+
+struct MctsWorker {
+    std::vector<MctsArm> arms;
+    BattleRng rng;
+    long long iterations = 0;
+};
+
+struct MctsSearch {
+    BattleState root;
+    BattleSide side = BattleSide::OPPONENT;
+    MctsConfig config;
+    std::vector<TurnInputs> candidates;
+    std::vector<MctsWorker> workers;
+    MctsClock::time_point start;
+    // Search time so far in frame-sliced builds
+    double spent_ms = 0.0;
+#if BATTLE_AI_THREADS
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+#endif
+
+    ~MctsSearch() {
+#if BATTLE_AI_THREADS
+        stop = true;
+        for (std::thread& t : threads) t.join();
+#endif
+    }
+};
+
+MctsPonder::MctsPonder() = default;
+MctsPonder::~MctsPonder() = default;
+
+static void shuffle_ids(CardList& list, BattleRng& rng) {
+    for (int i = list.size() - 1; i > 0; --i) {
+        std::swap(list.ids[i], list.ids[rng.below(i + 1)]);
+    }
+}
+
+// A random plan for rollouts and root candidates: each immediate is played
+// with probability immediate_pct, each other card placed in a random empty
+// slot with probability place_pct
+static TurnInputs random_plan(const BattleState& state, BattleSide side, BattleRng& rng,
+                              int immediate_pct, int place_pct) {
+    const SideState& self = get_side_state(state, side);
+    TurnInputs inputs;
+    bool taken[2][6];
+    int free_slots = 0;
+    for (int r = 0; r < 2; ++r) {
+        for (int c = 0; c < 6; ++c) {
+            taken[r][c] = slot_live(self.live, r, c);
+            if (!taken[r][c]) free_slots++;
+        }
+    }
+
+    int count = self.hand.size();
+    int order[BATTLE_DECK_CAPACITY];
+    bool played[BATTLE_DECK_CAPACITY] = {};
+    for (int i = 0; i < count; ++i) order[i] = i;
+    for (int i = count - 1; i > 0; --i) std::swap(order[i], order[rng.below(i + 1)]);
+
+    for (int n = 0; n < count; ++n) {
+        int k = order[n];
+        const CardDef& def = card_def(self.hand[k]);
+        int row = -1, col = -1;
+        if (def.kind == CardKind::IMMEDIATE) {
+            if (rng.below(100) >= immediate_pct) continue;
+        } else {
+            if (def.hp <= 0 || free_slots == 0 || rng.below(100) >= place_pct) continue;
+            int pick = rng.below(free_slots);
+            for (int s = 0; s < 12 && row < 0; ++s) {
+                if (taken[s / 6][s % 6]) continue;
+                if (pick-- == 0) {
+                    row = s / 6;
+                    col = s % 6;
+                }
+            }
+            taken[row][col] = true;
+            free_slots--;
+        }
+        // Hand indices shift down past every card already played
+        int idx = k;
+        for (int j = 0; j < k; ++j) {
+            if (played[j]) idx--;
+        }
+        played[k] = true;
+        inputs.push_back({idx, row, col});
+    }
+    return inputs;
+}
+
+// What a plan leaves behind, to drop duplicate candidates
+static std::vector<CardId> plan_signature(const BattleState& root, BattleSide side, const TurnInputs& plan) {
+    BattleState copy = root;
+    copy.events = nullptr;
+    apply_turn_inputs(copy, side, plan);
+    const SideState& self = get_side_state(copy, side);
+    std::vector<CardId> sig;
+    for (int r = 0; r < 2; ++r) {
+        for (int c = 0; c < 6; ++c) sig.push_back(self.field[r][c].id);
+    }
+    std::vector<CardId> queued(self.immediate_queue.ids, self.immediate_queue.ids + self.immediate_queue.size());
+    std::sort(queued.begin(), queued.end());
+    sig.insert(sig.end(), queued.begin(), queued.end());
+    return sig;
+}
+
+static void make_candidates(MctsSearch& s, BattleRng& rng) {
+    std::vector<std::vector<CardId>> seen;
+    auto add = [&](TurnInputs plan) {
+        std::vector<CardId> sig = plan_signature(s.root, s.side, plan);
+        if (std::find(seen.begin(), seen.end(), sig) != seen.end()) return;
+        seen.push_back(std::move(sig));
+        s.candidates.push_back(std::move(plan));
+    };
+    // The built-in plan comes first, so an unsearched turn falls back to it
+    add(plan_turn(s.root, s.side));
+    static const int immediate_pcts[] = {100, 50};
+    static const int place_pcts[] = {100, 75, 50};
+    int limit = std::max(1, s.config.candidates);
+    for (int attempt = 0; attempt < limit * 8 && (int)s.candidates.size() < limit; ++attempt) {
+        add(random_plan(s.root, s.side, rng, immediate_pcts[attempt % 2], place_pcts[(attempt / 2) % 3]));
+    }
+}
+
+// Re-deals what the searching side can't see: the other side's hand comes
+// from its hand and deck together, both draw piles are reshuffled, and the
+// battle rng is reseeded
+static void determinise(BattleState& sim, BattleSide side, BattleRng& rng) {
+    SideState& other = get_side_state(sim, opposite_side(side));
+    CardList pool = other.deck;
+    for (int i = 0; i < other.hand.size(); ++i) pool.push_back(other.hand[i]);
+    shuffle_ids(pool, rng);
+    int hand_size = other.hand.size();
+    other.hand.count = 0;
+    other.deck.count = 0;
+    for (int i = 0; i < pool.size(); ++i) {
+        if (i < hand_size) other.hand.push_back(pool[i]);
+        else other.deck.push_back(pool[i]);
+    }
+    shuffle_ids(get_side_state(sim, side).deck, rng);
+    sim.rng.seed(((uint64_t)rng.next() << 32) | rng.next());
+}
+
+static double field_value(const SideState& side) {
+    double value = 0.0;
+    for (int r = 0; r < 2; ++r) {
+        for (int c = 0; c < 6; ++c) {
+            const Card& card = side.field[r][c];
+            if (card.hp > 0) value += card.hp + 2.0 * card.dmg * side.damage_multiplier;
+        }
+    }
+    return value;
+}
+
+// 1 for a win, 0 for a loss, otherwise from the ship HP and board balance
+static double evaluate(const BattleState& sim, BattleSide side) {
+    const SideState& self = get_side_state(sim, side);
+    const SideState& other = get_side_state(sim, opposite_side(side));
+    if (self.hp <= 0 || other.hp <= 0) {
+        if (self.hp > 0) return 1.0;
+        if (other.hp > 0) return 0.0;
+        return 0.5;
+    }
+    double margin = (self.hp - other.hp) + 0.5 * (field_value(self) - field_value(other));
+    return 0.5 + 0.5 * std::tanh(margin / 4000.0);
+}
+
+static int select_arm(const MctsSearch& s, const MctsWorker& w) {
+    long long total = 0;
+    for (size_t i = 0; i < w.arms.size(); ++i) {
+        if (w.arms[i].visits == 0) return (int)i;
+        total += w.arms[i].visits;
+    }
+    double log_total = std::log((double)total);
+    int best = 0;
+    double best_score = -1.0;
+    for (size_t i = 0; i < w.arms.size(); ++i) {
+        const MctsArm& arm = w.arms[i];
+        double score = arm.value / arm.visits + s.config.exploration * std::sqrt(log_total / arm.visits);
+        if (score > best_score) {
+            best_score = score;
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+static void resolve_sides(BattleState& sim, BattleSide side, const TurnInputs& mine, const TurnInputs& theirs) {
+    if (side == BattleSide::PLAYER) resolve_turn(sim, mine, theirs);
+    else resolve_turn(sim, theirs, mine);
+}
+
+static void run_iteration(const MctsSearch& s, MctsWorker& w) {
+    int arm = select_arm(s, w);
+    BattleState sim = s.root;
+    determinise(sim, s.side, w.rng);
+    BattleSide other = opposite_side(s.side);
+    resolve_sides(sim, s.side, s.candidates[arm], random_plan(sim, other, w.rng, 75, 90));
+    for (int t = 0; t < s.config.rollout_turns && !battle_over(sim); ++t) {
+        TurnInputs player = random_plan(sim, BattleSide::PLAYER, w.rng, 75, 90);
+        TurnInputs opponent = random_plan(sim, BattleSide::OPPONENT, w.rng, 75, 90);
+        resolve_turn(sim, player, opponent);
+    }
+    w.arms[arm].visits++;
+    w.arms[arm].value += evaluate(sim, s.side);
+    w.iterations++;
+}
+
+static double elapsed_ms(const MctsSearch& s) {
+#if BATTLE_AI_THREADS
+    return std::chrono::duration<double, std::milli>(MctsClock::now() - s.start).count();
+#else
+    return s.spent_ms;
+#endif
+}
+
+static bool search_done(const MctsSearch& s, const MctsWorker& w) {
+    if (s.candidates.size() <= 1) return true;
+    if (s.config.max_iterations > 0 && w.iterations >= s.config.max_iterations) return true;
+    return s.config.budget_ms > 0.0 && elapsed_ms(s) >= s.config.budget_ms;
+}
+
+#if BATTLE_AI_THREADS
+static void worker_loop(MctsSearch* s, int index) {
+    MctsWorker& w = s->workers[index];
+    while (!s->stop.load(std::memory_order_relaxed) && !search_done(*s, w)) {
+        for (int i = 0; i < 8; ++i) run_iteration(*s, w);
+    }
+}
+#endif
+
+void mcts_ponder_start(MctsPonder& ponder, const BattleState& state, BattleSide side, const MctsConfig& config) {
+    ponder.search.reset();
+    auto s = std::make_unique<MctsSearch>();
+    s->root = state;
+    s->root.events = nullptr;
+    s->side = side;
+    s->config = config;
+    if (s->config.budget_ms <= 0.0 && s->config.max_iterations <= 0) s->config.budget_ms = MctsConfig{}.budget_ms;
+
+    BattleRng rng;
+    rng.seed(config.seed ^ state.rng.state);
+    make_candidates(*s, rng);
+
+    int workers = 1;
+#if BATTLE_AI_THREADS
+    workers = config.threads;
+    if (workers <= 0) workers = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+#endif
+    s->workers.resize(workers);
+    for (MctsWorker& w : s->workers) {
+        w.arms.resize(s->candidates.size());
+        w.rng.seed(((uint64_t)rng.next() << 32) | rng.next());
+    }
+
+    s->start = MctsClock::now();
+#if BATTLE_AI_THREADS
+    for (int i = 0; i < workers; ++i) s->threads.emplace_back(worker_loop, s.get(), i);
+#endif
+    ponder.search = std::move(s);
+}
+
+void mcts_ponder_step(MctsPonder& ponder, double slice_ms) {
+#if !BATTLE_AI_THREADS
+    if (!ponder.search) return;
+    MctsSearch& s = *ponder.search;
+    MctsWorker& w = s.workers[0];
+    MctsClock::time_point slice_start = MctsClock::now();
+    double spent_before = s.spent_ms;
+    while (!search_done(s, w)) {
+        for (int i = 0; i < 8; ++i) run_iteration(s, w);
+        double slice = std::chrono::duration<double, std::milli>(MctsClock::now() - slice_start).count();
+        s.spent_ms = spent_before + slice;
+        if (slice >= slice_ms) break;
+    }
+#else
+    (void)ponder;
+    (void)slice_ms;
+#endif
+}
+
+TurnInputs mcts_ponder_finish(MctsPonder& ponder, const BattleState& state, BattleSide side) {
+    if (!ponder.search || ponder.search->side != side) {
+        ponder.search.reset();
+        return plan_turn(state, side);
+    }
+    MctsSearch& s = *ponder.search;
+#if BATTLE_AI_THREADS
+    s.stop = true;
+    for (std::thread& t : s.threads) t.join();
+    s.threads.clear();
+#endif
+    // Root-parallel: the workers' statistics add up per candidate
+    std::vector<MctsArm> arms(s.candidates.size());
+    for (const MctsWorker& w : s.workers) {
+        for (size_t i = 0; i < arms.size(); ++i) {
+            arms[i].visits += w.arms[i].visits;
+            arms[i].value += w.arms[i].value;
+        }
+    }
+    size_t best = 0;
+    for (size_t i = 1; i < arms.size(); ++i) {
+        if (arms[i].visits > arms[best].visits ||
+            (arms[i].visits == arms[best].visits && arms[i].visits > 0 &&
+             arms[i].value / arms[i].visits > arms[best].value / arms[best].visits)) {
+            best = i;
+        }
+    }
+    TurnInputs plan = s.candidates[best];
+    ponder.search.reset();
+    return plan;
+}
+
+void mcts_ponder_cancel(MctsPonder& ponder) {
+    ponder.search.reset();
+}
+
+bool mcts_pondering(const MctsPonder& ponder) {
+    return ponder.search != nullptr;
+}
+
+TurnInputs mcts_plan_turn(const BattleState& state, BattleSide side, const MctsConfig& config) {
+    MctsPonder ponder;
+    mcts_ponder_start(ponder, state, side, config);
+#if BATTLE_AI_THREADS
+    for (std::thread& t : ponder.search->threads) t.join();
+    ponder.search->threads.clear();
+#else
+    MctsSearch& s = *ponder.search;
+    while (!search_done(s, s.workers[0])) mcts_ponder_step(ponder, 1000.0);
+#endif
+    return mcts_ponder_finish(ponder, state, side);
+}
@@ -0,0 +1,61 @@
+#ifndef BATTLE_AI_H
+#define BATTLE_AI_H
+
+// Monte Carlo tree search opponent. Planning is simultaneous, so the search
+// only sees the other side's hand as a count: every iteration deals it a
+// fresh determinisation from its hidden cards, samples its moves, and plays
+// the turn plus a short random rollout. The tree is a UCB1 bandit over
+// candidate placement plans for the searching side's turn.
+
+#include "battle_sim.h"
+#include <cstdint>
+#include <memory>
+
+// Single-threaded emscripten builds search in frame slices instead
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define BATTLE_AI_THREADS 0
+#else
+#define BATTLE_AI_THREADS 1
+#endif
+
+struct MctsConfig {
+    // Search time per turn (ms); <= 0 for no limit, with max_iterations set
+    double budget_ms = 250.0;
+    // Per worker; 0 for no limit
+    long long max_iterations = 0;
+    // Root-parallel workers; 0 for one per core
+    int threads = 0;
+    // Placement plans considered at the root, the built-in plan included
+    int candidates = 48;
+    // Turns played out at random after the searched one
+    int rollout_turns = 4;
+    double exploration = 0.7;
+    // Mixed with the battle's rng state
+    uint64_t seed = 0;
+};
+
+struct MctsSearch;
+
+// A search running in the background while the other side plans
+struct MctsPonder {
+    std::unique_ptr<MctsSearch> search;
+
+    MctsPonder();
+    ~MctsPonder();
+};
+
+// Blocking search from state at the start of planning
+TurnInputs mcts_plan_turn(const BattleState& state, BattleSide side, const MctsConfig& config);
+
+// Starts searching side's turn from state, replacing any running search
+void mcts_ponder_start(MctsPonder& ponder, const BattleState& state, BattleSide side, const MctsConfig& config);
+// Without worker threads the search only advances here; call it every
+// frame with the time it may take. A no-op otherwise.
+void mcts_ponder_step(MctsPonder& ponder, double slice_ms);
+// Stops the search and returns its best plan, or plan_turn's when nothing
+// was searched. Inputs are valid for the searched side until it plays.
+TurnInputs mcts_ponder_finish(MctsPonder& ponder, const BattleState& state, BattleSide side);
+void mcts_ponder_cancel(MctsPonder& ponder);
+bool mcts_pondering(const MctsPonder& ponder);
+
+#endif
@@ -0,0 +1,258 @@
+#include "battle_replay.h"
+#include "cards.hpp"
+#include <cstring>
+
+static const char k_replay_magic[4] = {'S', 'G', 'R', 'P'};
+
+// --- State hash ------------------------------------------------------------
+
+static void hash_bytes(uint64_t& h, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 0x100000001B3ull;
+    }
+}
+
+template <typename T>
+static void hash_value(uint64_t& h, const T& value) {
+    hash_bytes(h, &value, sizeof(value));
+}
+
+static void hash_list(uint64_t& h, const CardList& list) {
+    hash_value(h, list.count);
+    hash_bytes(h, list.ids, list.count);
+}
+
+static void hash_side(uint64_t& h, const SideState& side) {
+    hash_value(h, side.hp);
+    hash_value(h, side.damage_multiplier);
+    hash_list(h, side.deck);
+    hash_list(h, side.hand);
+    hash_list(h, side.immediate_queue);
+    for (int r = 0; r < 2; ++r) {
+        for (int c = 0; c < 6; ++c) {
+            const Card& card = side.field[r][c];
+            hash_value(h, card.id);
+            hash_value(h, card.hp);
+            hash_value(h, card.max_hp);
+            hash_value(h, card.dmg);
+            hash_value(h, card.base_dmg);
+            hash_value(h, card.state.times_used);
+            hash_value(h, card.state.cooldown);
+            hash_value(h, card.state.skip_this_turn);
+        }
+    }
+}
+
+uint64_t battle_state_hash(const BattleState& state) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    hash_side(h, state.player);
+    hash_side(h, state.opponent);
+    hash_value(h, state.skip_attack_phase);
+    hash_value(h, state.turn);
+    hash_value(h, state.rng.state);
+    return h;
+}
+
+// --- Playback --------------------------------------------------------------
+
+void start_replay(BattleReplay& replay, uint64_t seed, const std::vector<CardId>& player_deck,
+                  const std::vector<CardId>& opponent_deck) {
+    replay = BattleReplay{};
+    replay.seed = seed;
+    replay.player_deck = player_deck;
+    replay.opponent_deck = opponent_deck;
+}
+
+bool run_replay(const BattleReplay& replay, BattleState& out,
+                const std::function<void(const BattleState&)>& after_turn) {
+    if (!init_battle_state(out, replay.player_deck, replay.opponent_deck, replay.seed)) return false;
+    for (const ReplayTurn& turn : replay.turns) {
+        for (const PlayAction& action : turn.player) {
+            if (!play_card(out, BattleSide::PLAYER, action)) return false;
+        }
+        for (const PlayAction& action : turn.opponent) {
+            if (!play_card(out, BattleSide::OPPONENT, action)) return false;
+        }
+        if (begin_resolution(out)) {
+            for (int step = 0; step < BATTLE_ATTACK_STEPS; ++step) resolve_attack_step(out, step);
+        }
+        if (after_turn) after_turn(out);
+    }
+    return true;
+}
+
+// --- Binary form -----------------------------------------------------------
+
+static void put_u8(std::vector<uint8_t>& out, uint8_t v) {
+    out.push_back(v);
+}
+
+static void put_uint(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put_deck(std::vector<uint8_t>& out, const std::vector<CardId>& deck) {
+    put_uint(out, deck.size(), 2);
+    out.insert(out.end(), deck.begin(), deck.end());
+}
+
+static void put_inputs(std::vector<uint8_t>& out, const TurnInputs& inputs) {
+    put_u8(out, (uint8_t)inputs.size());
+    for (const PlayAction& action : inputs) {
+        put_u8(out, (uint8_t)action.hand_idx);
+        put_u8(out, (uint8_t)(int8_t)action.row);
+        put_u8(out, (uint8_t)(int8_t)action.col);
+    }
+}
+
+std::vector<uint8_t> encode_replay(const BattleReplay& replay) {
+    std::vector<uint8_t> out(k_replay_magic, k_replay_magic + 4);
+    put_uint(out, BATTLE_REPLAY_VERSION, 2);
+    put_u8(out, cards::COUNT);
+    put_uint(out, replay.seed, 8);
+    put_deck(out, replay.player_deck);
+    put_deck(out, replay.opponent_deck);
+    put_uint(out, replay.turns.size(), 4);
+    for (const ReplayTurn& turn : replay.turns) {
+        put_inputs(out, turn.player);
+        put_inputs(out, turn.opponent);
+    }
+    put_uint(out, replay.final_hash, 8);
+    return out;
+}
+
+struct ReplayReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+
+    bool take(size_t n) { return size - pos >= n; }
+    uint64_t uint(int bytes) {
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= (uint64_t)data[pos++] << (8 * i);
+        return v;
+    }
+};
+
+static bool read_deck(ReplayReader& in, std::vector<CardId>& deck) {
+    if (!in.take(2)) return false;
+    size_t count = in.uint(2);
+    if (count > BATTLE_DECK_CAPACITY || !in.take(count)) return false;
+    deck.assign(in.data + in.pos, in.data + in.pos + count);
+    in.pos += count;
+    for (CardId id : deck) {
+        if (id >= cards::COUNT) return false;
+    }
+    return true;
+}
+
+static bool read_inputs(ReplayReader& in, TurnInputs& inputs) {
+    if (!in.take(1)) return false;
+    size_t count = in.uint(1);
+    if (!in.take(count * 3)) return false;
+    inputs.resize(count);
+    for (PlayAction& action : inputs) {
+        action.hand_idx = (int)in.uint(1);
+        action.row = (int8_t)in.uint(1);
+        action.col = (int8_t)in.uint(1);
+    }
+    return true;
+}
+
+bool decode_replay(const uint8_t* data, size_t size, BattleReplay& out, std::string& error) {
+    ReplayReader in{data, size};
+    out = BattleReplay{};
+    if (!in.take(4) || std::memcmp(data, k_replay_magic, 4) != 0) {
+        error = "not a replay";
+        return false;
+    }
+    in.pos = 4;
+    if (!in.take(11)) {
+        error = "truncated header";
+        return false;
+    }
+    uint64_t version = in.uint(2);
+    if (version != BATTLE_REPLAY_VERSION) {
+        error = "replay version " + std::to_string(version) + ", expected " + std::to_string(BATTLE_REPLAY_VERSION);
+        return false;
+    }
+    uint64_t catalog = in.uint(1);
+    if (catalog != cards::COUNT) {
+        error = "replay was recorded with " + std::to_string(catalog) + " cards, this build has " +
+                std::to_string(cards::COUNT);
+        return false;
+    }
+    out.seed = in.uint(8);
+    if (!read_deck(in, out.player_deck) || !read_deck(in, out.opponent_deck)) {
+        error = "bad decklist";
+        return false;
+    }
+    if (!in.take(4)) {
+        error = "truncated turns";
+        return false;
+    }
+    size_t turns = in.uint(4);
+    // Each turn takes at least two bytes
+    if (turns > (size - in.pos) / 2) {
+        error = "truncated turns";
+        return false;
+    }
+    out.turns.resize(turns);
+    for (ReplayTurn& turn : out.turns) {
+        if (!read_inputs(in, turn.player) || !read_inputs(in, turn.opponent)) {
+            error = "truncated turns";
+            return false;
+        }
+    }
+    if (!in.take(8)) {
+        error = "missing state hash";
+        return false;
+    }
+    out.final_hash = in.uint(8);
+    return true;
+}
+
+// --- Text form -------------------------------------------------------------
+
+static const char k_base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string replay_to_text(const BattleReplay& replay) {
+    std::vector<uint8_t> bytes = encode_replay(replay);
+    std::string text;
+    text.reserve((bytes.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        uint32_t chunk = (uint32_t)bytes[i] << 16;
+        if (i + 1 < bytes.size()) chunk |= (uint32_t)bytes[i + 1] << 8;
+        if (i + 2 < bytes.size()) chunk |= bytes[i + 2];
+        text += k_base64[(chunk >> 18) & 63];
+        text += k_base64[(chunk >> 12) & 63];
+        text += (i + 1 < bytes.size()) ? k_base64[(chunk >> 6) & 63] : '=';
+        text += (i + 2 < bytes.size()) ? k_base64[chunk & 63] : '=';
+    }
+    return text;
+}
+
+bool replay_from_text(const std::string& text, BattleReplay& out, std::string& error) {
+    std::vector<uint8_t> bytes;
+    uint32_t chunk = 0;
+    int bits = 0;
+    for (char ch : text) {
+        // Whitespace from pasting is skipped, padding ends the data
+        if (ch == '=') break;
+        const char* at = std::strchr(k_base64, ch);
+        if (ch == '\0' || !at) {
+            if (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t') continue;
+            error = "not base64";
+            return false;
+        }
+        chunk = (chunk << 6) | (uint32_t)(at - k_base64);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            bytes.push_back((uint8_t)(chunk >> bits));
+        }
+    }
+    return decode_replay(bytes.data(), bytes.size(), out, error);
+}
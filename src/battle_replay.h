@@ -0,0 +1,56 @@
+#ifndef BATTLE_REPLAY_H
+#define BATTLE_REPLAY_H
+
+// A battle is its seed, both decklists and each turn's played cards;
+// replaying those through the rules reproduces it exactly. The binary
+// form, little-endian:
+//
+//   "SGRP"  u16 version  u8 catalog size  u64 seed
+//   2x { u16 count, count x u8 card id }               decklists
+//   u32 turns, turns x 2x { u8 count, count x {u8 hand_idx, i8 row, i8 col} }
+//   u64 hash of the state after the last turn
+//
+// The text form is that in base64, for the clipboard.
+
+#include "battle_sim.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+static constexpr uint16_t BATTLE_REPLAY_VERSION = 1;
+
+struct ReplayTurn {
+    TurnInputs player;
+    TurnInputs opponent;
+};
+
+struct BattleReplay {
+    uint64_t seed = 0;
+    std::vector<CardId> player_deck;
+    std::vector<CardId> opponent_deck;
+    std::vector<ReplayTurn> turns;
+    uint64_t final_hash = 0;
+};
+
+// FNV-1a over everything that decides the rest of the battle
+uint64_t battle_state_hash(const BattleState& state);
+
+void start_replay(BattleReplay& replay, uint64_t seed, const std::vector<CardId>& player_deck,
+                  const std::vector<CardId>& opponent_deck);
+// Plays the replay from the start, recording to out.events if set; false if
+// an input was rejected. out holds the state after the last turn. after_turn,
+// if given, sees the state once each turn has resolved, e.g. to drain events
+// before the ring wraps.
+bool run_replay(const BattleReplay& replay, BattleState& out,
+                const std::function<void(const BattleState&)>& after_turn = nullptr);
+
+std::vector<uint8_t> encode_replay(const BattleReplay& replay);
+// False, with error set, for truncated data, another version or another
+// card catalog
+bool decode_replay(const uint8_t* data, size_t size, BattleReplay& out, std::string& error);
+
+std::string replay_to_text(const BattleReplay& replay);
+bool replay_from_text(const std::string& text, BattleReplay& out, std::string& error);
+
+#endif
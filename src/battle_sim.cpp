@@ -0,0 +1,623 @@
+#include "battle_sim.h"
+#include "cards.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+const int BATTLE_ATTACK_COLS[BATTLE_ATTACK_STEPS][2] = {{0, 5}, {1, 4}, {2, 3}};
+
+void BattleRng::seed(uint64_t seed) {
+    // splitmix64 step, so nearby seeds still start far apart; never zero
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    state = (z ^ (z >> 31)) | 1;
+}
+
+uint32_t BattleRng::next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (uint32_t)((state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+int BattleRng::below(int n) {
+    if (n <= 1) return 0;
+    return (int)(((uint64_t)next() * (uint64_t)n) >> 32);
+}
+
+static void shuffle_deck(BattleState& state, CardList& deck) {
+    for (int i = deck.size() - 1; i > 0; --i) {
+        std::swap(deck.ids[i], deck.ids[state.rng.below(i + 1)]);
+    }
+}
+
+const CardDef& card_def(CardId id) {
+    return cards::all()[id];
+}
+
+Card make_card(CardId id) {
+    const CardDef& def = card_def(id);
+    Card card;
+    card.id = id;
+    card.hp = card.max_hp = def.hp;
+    card.dmg = card.base_dmg = def.dmg;
+    return card;
+}
+
+SideState& get_side_state(BattleState& state, BattleSide side) {
+    return (side == BattleSide::PLAYER) ? state.player : state.opponent;
+}
+
+const SideState& get_side_state(const BattleState& state, BattleSide side) {
+    return (side == BattleSide::PLAYER) ? state.player : state.opponent;
+}
+
+// Every change to a field card's HP goes through one of these, so the live
+// mask always matches the field
+static void update_live(SideState& side, int row, int col) {
+    uint16_t bit = (uint16_t)(1u << (row * 6 + col));
+    if (side.field[row][col].hp > 0) side.live |= bit;
+    else side.live &= (uint16_t)~bit;
+}
+
+// For effects, which only know the card: no-op for cards off the field
+static void update_live(SideState& side, const Card& card) {
+    for (int slot = 0; slot < 12; ++slot) {
+        if (&side.field[slot / 6][slot % 6] == &card) update_live(side, slot / 6, slot % 6);
+    }
+}
+
+BattleSide opposite_side(BattleSide side) {
+    return (side == BattleSide::PLAYER) ? BattleSide::OPPONENT : BattleSide::PLAYER;
+}
+
+const char* side_label(BattleSide side) {
+    return (side == BattleSide::PLAYER) ? "Player" : "Opponent";
+}
+
+const char* card_kind_label(CardKind kind) {
+    switch (kind) {
+        case CardKind::NORMAL: return "Normal";
+        case CardKind::SPECIAL: return "Special";
+        case CardKind::IMMEDIATE: return "Immediate";
+        case CardKind::FIELD_EFFECT: return "Field";
+    }
+    return "Normal";
+}
+
+void battle_event(BattleState& state, const BattleEvent& event) {
+    if (state.events) state.events->push(event);
+}
+
+static void emit(BattleState& state, BattleEventKind kind, BattleSide side, int row, int col, CardId card,
+                 int amount = 0, int target_col = -1) {
+    if (!state.events) return;
+    state.events->push({kind, side, (int8_t)row, (int8_t)col, (int8_t)target_col, card, amount});
+}
+
+static std::string at_slot(const char* prefix, const BattleEvent& event) {
+    return std::string(prefix) + std::to_string(event.row) + " col " + std::to_string(event.col);
+}
+
+std::string format_battle_event(const BattleEvent& e) {
+    const char* side = side_label(e.side);
+    const char* name = (e.card != CARD_NONE) ? card_def(e.card).name : "";
+    switch (e.kind) {
+    case BattleEventKind::PLACED:
+        return std::string(side) + " placed card " + name + at_slot(" at row ", e);
+    case BattleEventKind::QUEUED:
+        return std::string(side) + " queued immediate card " + name;
+    case BattleEventKind::ACTIVATED: {
+        const CardDef& def = card_def(e.card);
+        std::string loc = (e.row >= 0 && e.col >= 0) ? at_slot(" at row ", e) : "";
+        std::string desc = def.effect_description ? (std::string(": ") + def.effect_description) : "";
+        return std::string("Card ") + name + " (" + card_kind_label(def.kind) + ") from " + side + " activated" + loc + desc;
+    }
+    case BattleEventKind::DESTROYED_ON_ACTIVATION:
+        return std::string("Card ") + name + " from " + side + " was destroyed after activation";
+    case BattleEventKind::DESTROYED:
+        return std::string("Card ") + name + " from " + side + at_slot(" on row ", e) + " destroyed";
+    case BattleEventKind::ATTACK: {
+        const CardDef& def = card_def(e.card);
+        std::string text = std::string("Card ") + name + " (" + card_kind_label(def.kind) + ") from " + side + at_slot(" at row ", e);
+        if (e.target_col >= 0) {
+            text += " attacked column " + std::to_string(e.target_col) + " for " + std::to_string(e.amount) + " damage";
+        } else if (e.amount > 0) {
+            text += " attacked the ship for " + std::to_string(e.amount) + " damage";
+        } else {
+            text += " had no available target";
+        }
+        text += std::string(" (special effect: ") + (def.effect_description ? def.effect_description : "None") + ")";
+        return text;
+    }
+    case BattleEventKind::SLOT_DAMAGED:
+    case BattleEventKind::SLOT_MENDED:
+        return "";
+    case BattleEventKind::SLOT_HEALED:
+        return std::string("Card ") + name + " from " + side + at_slot(" at row ", e) + " healed " + std::to_string(e.amount);
+    case BattleEventKind::SHIP_DAMAGED:
+        return std::string("Ship of ") + side + " took " + std::to_string(e.amount) + " damage";
+    case BattleEventKind::SHIP_HEALED:
+        return std::string("Ship of ") + side + " healed " + std::to_string(e.amount);
+    case BattleEventKind::BATTLE_STARTED:
+        return "Battle started";
+    case BattleEventKind::REWARD_GAINED:
+        return std::string("Reward gained: ") + name;
+    case BattleEventKind::STALEMATE:
+        return "Stalemate detected: ending battle.";
+    case BattleEventKind::REPLAY_COPIED:
+        return "Replay of " + std::to_string(e.amount) + " turns copied to clipboard";
+    }
+    return "";
+}
+
+// --- Card effect helpers ----------------------------------------------------
+
+// card is the card the effect belongs to: its field slot, or a copy for
+// immediates and field effects
+static void run_effect_step(BattleState& state, BattleSide side, Card& card, const EffectStep& step) {
+    if (card.state.times_used < step.after_uses) return;
+    BattleSide target = (step.target == EffectTarget::SELF) ? side : opposite_side(side);
+    switch (step.op) {
+    case EffectOp::NONE:
+        break;
+    case EffectOp::HEAL_SLOTS:
+        heal_all_slots(state, target, step.amount);
+        break;
+    case EffectOp::DAMAGE_SLOTS:
+        deal_damage_to_all_slots(state, target, step.amount);
+        break;
+    case EffectOp::HEAL_RANDOM_SLOT:
+    case EffectOp::HEAL_RANDOM_SLOT_QUIETLY:
+    case EffectOp::DAMAGE_RANDOM_SLOT: {
+        int row, col;
+        if (random_live_slot(state, target, row, col)) {
+            if (step.op == EffectOp::DAMAGE_RANDOM_SLOT) damage_slot(state, target, row, col, step.amount);
+            else heal_slot(state, target, row, col, step.amount, step.op == EffectOp::HEAL_RANDOM_SLOT_QUIETLY);
+        }
+        break;
+    }
+    case EffectOp::HEAL_SHIP:
+        heal_ship(state, target, step.amount);
+        break;
+    case EffectOp::DAMAGE_SHIP:
+        deal_damage_to_ship(state, target, step.amount);
+        break;
+    case EffectOp::DRAW:
+        draw_cards(state, target, step.amount);
+        break;
+    case EffectOp::MULTIPLY_DAMAGE:
+        get_side_state(state, target).damage_multiplier *= step.factor;
+        break;
+    case EffectOp::SKIP_ATTACK_PHASE:
+        state.skip_attack_phase = true;
+        break;
+    case EffectOp::FIRE_EVERY_OTHER_TURN:
+        if ((card.state.times_used % 2) == 0) card.state.skip_this_turn = true;
+        break;
+    case EffectOp::SELF_DESTRUCT:
+        card.hp = 0;
+        update_live(get_side_state(state, side), card);
+        break;
+    case EffectOp::SCALE_WITH_ALLIES: {
+        const CardDef& def = card.def();
+        int live = count_live_cards(get_side_state(state, side));
+        int other = std::max(0, live - 1);
+        card.dmg = card.base_dmg = std::max(1, def.dmg - step.amount * other);
+        card.max_hp = std::max(1, def.hp - step.amount2 * live);
+        if (card.hp > card.max_hp) card.hp = card.max_hp;
+        break;
+    }
+    }
+}
+
+static void run_effect(BattleState& state, BattleSide side, Card& card, const CardEffect& effect) {
+    for (const EffectStep& step : effect.steps) {
+        if (step.op == EffectOp::NONE) break;
+        run_effect_step(state, side, card, step);
+    }
+}
+
+void card_took_damage_trigger(BattleState& state, BattleSide side, int row, int col, int amount) {
+    if (amount <= 0) return;
+    if (row < 0 || row >= 2 || col < 0 || col >= 6) return;
+    SideState& self = get_side_state(state, side);
+    Card& card = self.field[row][col];
+    if (card.empty()) return;
+    const CardEffect& on_damage = card.def().on_damage;
+    if (!on_damage.empty()) run_effect(state, side, card, on_damage);
+}
+
+void damage_slot(BattleState& state, BattleSide side, int row, int col, int amount) {
+    if (amount <= 0) return;
+    SideState& self = get_side_state(state, side);
+    Card& target = self.field[row][col];
+    if (target.hp <= 0) return;
+    int applied = std::min(amount, target.hp);
+    target.hp -= applied;
+    update_live(self, row, col);
+    emit(state, BattleEventKind::SLOT_DAMAGED, side, row, col, target.id, applied);
+    card_took_damage_trigger(state, side, row, col, applied);
+}
+
+void heal_slot(BattleState& state, BattleSide side, int row, int col, int amount, bool quiet) {
+    SideState& self = get_side_state(state, side);
+    Card& target = self.field[row][col];
+    if (target.hp <= 0 || amount <= 0) return;
+    int before = target.hp;
+    target.hp = std::min(target.max_hp, target.hp + amount);
+    int healed = target.hp - before;
+    if (healed > 0) {
+        emit(state, quiet ? BattleEventKind::SLOT_MENDED : BattleEventKind::SLOT_HEALED, side, row, col, target.id,
+             healed);
+    }
+}
+
+void deal_damage_to_all_slots(BattleState& state, BattleSide side, int amount) {
+    for (int r = 0; r < 2; ++r) {
+        for (int c = 0; c < 6; ++c) {
+            damage_slot(state, side, r, c, amount);
+        }
+    }
+}
+
+void heal_all_slots(BattleState& state, BattleSide side, int amount) {
+    for (int r = 0; r < 2; ++r) {
+        for (int c = 0; c < 6; ++c) {
+            heal_slot(state, side, r, c, amount);
+        }
+    }
+}
+
+void deal_damage_to_ship(BattleState& state, BattleSide side, int amount) {
+    if (amount <= 0) return;
+    SideState& self = get_side_state(state, side);
+    int applied = std::min(amount, self.hp);
+    self.hp -= applied;
+    emit(state, BattleEventKind::SHIP_DAMAGED, side, -1, -1, CARD_NONE, applied);
+}
+
+void heal_ship(BattleState& state, BattleSide side, int amount) {
+    if (amount <= 0) return;
+    SideState& self = get_side_state(state, side);
+    self.hp += amount;
+    emit(state, BattleEventKind::SHIP_HEALED, side, -1, -1, CARD_NONE, amount);
+}
+
+void draw_cards(BattleState& state, BattleSide side, int count) {
+    SideState& self = get_side_state(state, side);
+    for (int i = 0; i < count && !self.deck.empty(); ++i) {
+        if (!self.hand.push_back(self.deck.back())) break;
+        self.deck.pop_back();
+    }
+}
+
+bool random_live_slot(BattleState& state, BattleSide side, int& row, int& col) {
+    uint16_t live = get_side_state(state, side).live;
+    int count = std::popcount(live);
+    if (count == 0) return false;
+    // The pick-th live slot in row-major order
+    for (int pick = state.rng.below(count); pick > 0; --pick) live &= live - 1;
+    int slot = std::countr_zero(live);
+    row = slot / 6;
+    col = slot % 6;
+    return true;
+}
+
+int count_live_cards(const SideState& side) {
+    return std::popcount(side.live);
+}
+
+// --- Targeting ----------------------------------------------------------------
+
+static constexpr int scan_target_column(uint8_t columns, int start_col) {
+    // restrict targeting to the same half of the board; columns 0-2 and 3-5
+    // center columns (2 and 3) only target straight ahead
+    int min_col, max_col;
+    if (start_col == 2 || start_col == 3) {
+        min_col = max_col = start_col;
+    } else {
+        min_col = (start_col < 3) ? 0 : 3;
+        max_col = (start_col < 3) ? 2 : 5;
+    }
+
+    if (columns & (1 << start_col)) return start_col;
+
+    if (start_col < 3) {
+        for (int col = start_col + 1; col <= max_col; ++col) {
+            if (columns & (1 << col)) return col;
+        }
+    } else {
+        for (int col = start_col - 1; col >= min_col; --col) {
+            if (columns & (1 << col)) return col;
+        }
+    }
+    return -1;
+}
+
+// Target column for every set of occupied columns and attacking column
+struct TargetTable {
+    int8_t col[64][6];
+};
+
+static constexpr TargetTable make_target_table() {
+    TargetTable table{};
+    for (int columns = 0; columns < 64; ++columns) {
+        for (int c = 0; c < 6; ++c) table.col[columns][c] = (int8_t)scan_target_column((uint8_t)columns, c);
+    }
+    return table;
+}
+
+static constexpr TargetTable k_target_table = make_target_table();
+
+int find_target_column(uint16_t live, int start_col) {
+    return k_target_table.col[live_columns(live)][start_col];
+}
+
+bool center_columns_clear(uint16_t live, int start_col) {
+    // Only require the near-center column to be empty for ship hits
+    return !(live_columns(live) & (start_col < 3 ? 0x04 : 0x08));
+}
+
+int effective_damage(const Card& card, const SideState& side) {
+    return static_cast<int>(std::lround(card.dmg * side.damage_multiplier));
+}
+
+// --- Resolution ---------------------------------------------------------------
+
+static void cleanup_destroyed_cards_for_side(BattleState& state, BattleSide side) {
+    SideState& self = get_side_state(state, side);
+    for (int r = 0; r < 2; ++r) {
+        for (int c = 0; c < 6; ++c) {
+            Card& card = self.field[r][c];
+            if (card.hp <= 0 && !card.empty()) {
+                emit(state, BattleEventKind::DESTROYED, side, r, c, card.id);
+                card = Card{};
+                update_live(self, r, c);
+            }
+        }
+    }
+}
+
+static void cleanup_destroyed_cards(BattleState& state) {
+    cleanup_destroyed_cards_for_side(state, BattleSide::PLAYER);
+    cleanup_destroyed_cards_for_side(state, BattleSide::OPPONENT);
+}
+
+static void apply_card_effect(BattleState& state, BattleSide side, Card& card, int row, int col) {
+    const CardDef& def = card.def();
+    if (!def.effect.empty()) {
+        emit(state, BattleEventKind::ACTIVATED, side, row, col, def.id);
+        card.state.times_used++;
+        run_effect(state, side, card, def.effect);
+        if (card.hp <= 0 && !card.empty()) {
+            emit(state, BattleEventKind::DESTROYED_ON_ACTIVATION, side, row, col, def.id);
+        }
+        cleanup_destroyed_cards(state);
+    }
+}
+
+static void apply_attacks_for_side(BattleState& state, BattleSide attacker_side, int c) {
+    SideState& attacker = get_side_state(state, attacker_side);
+    SideState& defender = get_side_state(state, opposite_side(attacker_side));
+    auto& attacker_field = attacker.field;
+    auto& defender_field = defender.field;
+
+    for (int r = 0; r < 2; r++) {
+        if (state.skip_attack_phase) return;
+
+        Card& attacker_card = attacker_field[r][c];
+        if (attacker_card.hp <= 0) continue;
+
+        apply_card_effect(state, attacker_side, attacker_card, r, c);
+        if (attacker_card.hp <= 0) continue;
+        if (attacker_card.state.skip_this_turn) {
+            attacker_card.state.skip_this_turn = false;
+            continue;
+        }
+
+        int remaining_dmg = effective_damage(attacker_card, attacker);
+        if (remaining_dmg <= 0) continue;
+
+        int target_col = find_target_column(defender.live, c);
+        int total_unit_damage = 0;
+        int total_ship_damage = 0;
+
+        if (target_col >= 0) {
+            int row_order[2] = {0, 1};
+            if (attacker_side == BattleSide::PLAYER) {
+                row_order[0] = 1; row_order[1] = 0; // prioritize opponent bottom row
+            }
+            for (int i = 0; i < 2 && remaining_dmg > 0; ++i) {
+                int drow = row_order[i];
+                if (!slot_live(defender.live, drow, target_col)) continue;
+                Card& defender_card = defender_field[drow][target_col];
+
+                int dmg_to_deal = std::min(remaining_dmg, defender_card.hp);
+                defender_card.hp -= dmg_to_deal;
+                update_live(defender, drow, target_col);
+                remaining_dmg -= dmg_to_deal;
+                emit(state, BattleEventKind::SLOT_DAMAGED, opposite_side(attacker_side), drow, target_col,
+                     defender_card.id, dmg_to_deal);
+                total_unit_damage += dmg_to_deal;
+            }
+        } else if (remaining_dmg > 0 && center_columns_clear(defender.live, c)) {
+            defender.hp -= remaining_dmg;
+            total_ship_damage = remaining_dmg;
+            remaining_dmg = 0;
+        }
+
+        emit(state, BattleEventKind::ATTACK, attacker_side, r, c, attacker_card.id,
+             target_col >= 0 ? total_unit_damage : total_ship_damage, target_col);
+    }
+}
+
+static void apply_attacks_for_column(BattleState& state, int c) {
+    apply_attacks_for_side(state, BattleSide::PLAYER, c);
+    apply_attacks_for_side(state, BattleSide::OPPONENT, c);
+    cleanup_destroyed_cards(state);
+}
+
+static void apply_field_effect_cards(BattleState& state, BattleSide side) {
+    SideState& self = get_side_state(state, side);
+    CardList remaining;
+    for (int i = 0; i < self.deck.size(); ++i) {
+        const CardDef& def = card_def(self.deck[i]);
+        if (def.kind == CardKind::FIELD_EFFECT && !def.effect.empty()) {
+            Card copy = make_card(def.id);
+            apply_card_effect(state, side, copy, -1, -1);
+        } else {
+            remaining.push_back(def.id);
+        }
+    }
+    self.deck = remaining;
+    shuffle_deck(state, self.deck);
+}
+
+static void apply_immediate_effect_queues(BattleState& state) {
+    auto& p_queue = state.player.immediate_queue;
+    auto& o_queue = state.opponent.immediate_queue;
+    while (!p_queue.empty() || !o_queue.empty()) {
+        BattleSide chosen;
+        if (p_queue.empty()) chosen = BattleSide::OPPONENT;
+        else if (o_queue.empty()) chosen = BattleSide::PLAYER;
+        else chosen = state.rng.below(2) == 0 ? BattleSide::PLAYER : BattleSide::OPPONENT;
+
+        auto& queue = (chosen == BattleSide::PLAYER) ? p_queue : o_queue;
+        Card card = make_card(queue[0]);
+        queue.erase(0);
+        apply_card_effect(state, chosen, card, -1, -1);
+        if (state.player.hp <= 0 || state.opponent.hp <= 0) break;
+    }
+}
+
+bool init_battle_state(BattleState& state, const std::vector<CardId>& player_deck,
+                       const std::vector<CardId>& opponent_deck, uint64_t seed) {
+    if (player_deck.size() > BATTLE_DECK_CAPACITY || opponent_deck.size() > BATTLE_DECK_CAPACITY) return false;
+    BattleEventLog* events = state.events;
+    state = BattleState{};
+    state.events = events;
+    state.rng.seed(seed);
+
+    for (CardId id : player_deck) state.player.deck.push_back(id);
+    shuffle_deck(state, state.player.deck);
+    for (CardId id : opponent_deck) state.opponent.deck.push_back(id);
+    shuffle_deck(state, state.opponent.deck);
+    apply_field_effect_cards(state, BattleSide::PLAYER);
+    apply_field_effect_cards(state, BattleSide::OPPONENT);
+
+    draw_cards(state, BattleSide::PLAYER, 5);
+    draw_cards(state, BattleSide::OPPONENT, 5);
+    return true;
+}
+
+bool can_play_card(const BattleState& state, BattleSide side, const PlayAction& action) {
+    const SideState& self = get_side_state(state, side);
+    if (action.hand_idx < 0 || action.hand_idx >= self.hand.size()) return false;
+    const CardDef& def = card_def(self.hand[action.hand_idx]);
+    if (def.kind == CardKind::IMMEDIATE) return self.immediate_queue.size() < BATTLE_DECK_CAPACITY;
+    if (def.hp <= 0) return false;
+    if (action.row < 0 || action.row >= 2 || action.col < 0 || action.col >= 6) return false;
+    return !slot_live(self.live, action.row, action.col);
+}
+
+bool play_card(BattleState& state, BattleSide side, const PlayAction& action) {
+    if (!can_play_card(state, side, action)) return false;
+    SideState& self = get_side_state(state, side);
+    const CardDef& def = card_def(self.hand[action.hand_idx]);
+    self.hand.erase(action.hand_idx);
+    if (def.kind == CardKind::IMMEDIATE) {
+        emit(state, BattleEventKind::QUEUED, side, -1, -1, def.id);
+        self.immediate_queue.push_back(def.id);
+    } else {
+        emit(state, BattleEventKind::PLACED, side, action.row, action.col, def.id);
+        self.field[action.row][action.col] = make_card(def.id);
+        update_live(self, action.row, action.col);
+    }
+    return true;
+}
+
+void apply_turn_inputs(BattleState& state, BattleSide side, const TurnInputs& inputs) {
+    for (const PlayAction& action : inputs) {
+        play_card(state, side, action);
+    }
+}
+
+TurnInputs plan_turn(const BattleState& state, BattleSide side) {
+    const SideState& self = get_side_state(state, side);
+    TurnInputs inputs;
+    // Indices into the hand as it shrinks with each action
+    std::vector<const CardDef*> hand;
+    for (int i = 0; i < self.hand.size(); ++i) hand.push_back(&card_def(self.hand[i]));
+
+    for (size_t i = 0; i < hand.size();) {
+        if (hand[i]->kind == CardKind::IMMEDIATE) {
+            inputs.push_back({(int)i, -1, -1});
+            hand.erase(hand.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+
+    bool taken[2][6];
+    for (int r = 0; r < 2; ++r) {
+        for (int c = 0; c < 6; ++c) {
+            taken[r][c] = slot_live(self.live, r, c);
+        }
+    }
+    for (size_t i = 0; i < hand.size();) {
+        bool placed = false;
+        if (hand[i]->hp > 0) {
+            for (int r = 0; r < 2 && !placed; r++) {
+                for (int c = 0; c < 6 && !placed; c++) {
+                    if (taken[r][c]) continue;
+                    inputs.push_back({(int)i, r, c});
+                    taken[r][c] = true;
+                    placed = true;
+                }
+            }
+        }
+        if (placed) hand.erase(hand.begin() + i);
+        else ++i;
+    }
+    return inputs;
+}
+
+bool begin_resolution(BattleState& state) {
+    state.skip_attack_phase = false;
+    draw_cards(state, BattleSide::PLAYER, 2);
+    draw_cards(state, BattleSide::OPPONENT, 2);
+    apply_immediate_effect_queues(state);
+    cleanup_destroyed_cards(state);
+    state.turn++;
+    return state.player.hp > 0 && state.opponent.hp > 0;
+}
+
+void resolve_attack_step(BattleState& state, int step) {
+    apply_attacks_for_column(state, BATTLE_ATTACK_COLS[step][0]);
+    apply_attacks_for_column(state, BATTLE_ATTACK_COLS[step][1]);
+}
+
+void resolve_turn(BattleState& state, const TurnInputs& player, const TurnInputs& opponent) {
+    apply_turn_inputs(state, BattleSide::PLAYER, player);
+    apply_turn_inputs(state, BattleSide::OPPONENT, opponent);
+    if (!begin_resolution(state)) return;
+    for (int step = 0; step < BATTLE_ATTACK_STEPS; ++step) {
+        resolve_attack_step(state, step);
+    }
+}
+
+bool battle_over(const BattleState& state) {
+    return state.player.hp <= 0 || state.opponent.hp <= 0;
+}
+
+static bool side_has_play_resources(const SideState& side) {
+    if (!side.hand.empty()) return true;
+    if (!side.deck.empty()) return true;
+    return side.live != 0;
+}
+
+bool is_stalemate(const BattleState& state) {
+    return !side_has_play_resources(state.player) && !side_has_play_resources(state.opponent);
+}
@@ -0,0 +1,309 @@
+#ifndef BATTLE_SIM_H
+#define BATTLE_SIM_H
+
+// Battle rules with no SDL, ImGui or Emscripten dependency. Everything
+// acts on an explicit BattleState, so battles can run headless at full
+// speed; the game's battle screen is one client of this.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+enum class CardType {
+    SHIELD,
+    TURRET,
+    DRONE,
+    UTILITY,
+    DEFAULT
+};
+
+enum class BattleSide {
+    PLAYER,
+    OPPONENT
+};
+
+enum class CardKind {
+    NORMAL,
+    SPECIAL,
+    IMMEDIATE,
+    FIELD_EFFECT
+};
+
+// Index into the card catalog (cards::all())
+using CardId = uint8_t;
+static constexpr CardId CARD_NONE = 0xFF;
+
+// What one step of a card effect does; run_effect_step dispatches on it
+enum class EffectOp : uint8_t {
+    NONE,
+    HEAL_SLOTS,            // every live card of target heals amount
+    DAMAGE_SLOTS,          // every live card of target takes amount
+    HEAL_RANDOM_SLOT,      // one random live card of target heals amount
+    // As HEAL_RANDOM_SLOT, with a heal marker but no log line
+    HEAL_RANDOM_SLOT_QUIETLY,
+    DAMAGE_RANDOM_SLOT,    // one random live card of target takes amount
+    HEAL_SHIP,
+    DAMAGE_SHIP,
+    DRAW,                  // target draws amount cards
+    MULTIPLY_DAMAGE,       // target's damage multiplier *= factor
+    SKIP_ATTACK_PHASE,
+    FIRE_EVERY_OTHER_TURN, // the card itself skips every second attack
+    SELF_DESTRUCT,         // the card itself drops to 0 HP
+    // The card itself: damage is its base minus amount per other friendly
+    // card, HP cap its base minus amount2 per friendly card (both min 1)
+    SCALE_WITH_ALLIES,
+};
+
+enum class EffectTarget : uint8_t {
+    SELF,
+    ENEMY
+};
+
+struct EffectStep {
+    EffectOp op = EffectOp::NONE;
+    EffectTarget target = EffectTarget::SELF;
+    // Only runs once the card has been used this many times
+    uint8_t after_uses = 0;
+    int amount = 0;
+    int amount2 = 0;
+    double factor = 1.0;
+};
+
+static constexpr int CARD_EFFECT_STEPS = 2;
+
+// A card's effect as data: up to CARD_EFFECT_STEPS steps, run in order
+struct CardEffect {
+    EffectStep steps[CARD_EFFECT_STEPS] = {};
+
+    constexpr bool empty() const { return steps[0].op == EffectOp::NONE; }
+};
+
+// Immutable card definition, one per catalog entry; battles only refer to
+// it by id
+struct CardDef {
+    CardId id;
+    const char* name;
+    int hp;
+    int dmg;
+    int cost;
+    CardType type;
+    CardKind kind;
+    CardEffect effect;
+    // Runs when the card takes damage on the field
+    CardEffect on_damage;
+    const char* effect_description; // nullptr when the card has none
+};
+
+const CardDef& card_def(CardId id);
+
+struct CardState {
+    uint16_t times_used = 0;
+    uint8_t cooldown = 0;
+    bool skip_this_turn = false;
+};
+
+// A card on the field: its definition plus what the battle changed
+struct Card {
+    int hp = 0;
+    int max_hp = 0;
+    int dmg = 0;
+    int base_dmg = 0;
+    CardState state;
+    CardId id = CARD_NONE;
+
+    bool empty() const { return id == CARD_NONE; }
+    const CardDef& def() const { return card_def(id); }
+};
+
+Card make_card(CardId id);
+
+// Largest deck a battle takes. The player stops getting reward cards once
+// their deck is this big, generated decks stop growing at it, and longer
+// decklists from replays or the balance tool are rejected.
+static constexpr int BATTLE_DECK_CAPACITY = 64;
+
+// Fixed-capacity list of card ids for decks, hands and queues; push_back
+// fails when full.
+struct CardList {
+    CardId ids[BATTLE_DECK_CAPACITY];
+    uint8_t count = 0;
+
+    bool empty() const { return count == 0; }
+    int size() const { return count; }
+    CardId operator[](int i) const { return ids[i]; }
+    CardId back() const { return ids[count - 1]; }
+    void pop_back() { --count; }
+    bool push_back(CardId id) {
+        if (count >= BATTLE_DECK_CAPACITY) return false;
+        ids[count++] = id;
+        return true;
+    }
+    void erase(int i) {
+        for (int k = i; k + 1 < count; ++k) ids[k] = ids[k + 1];
+        --count;
+    }
+};
+
+// xorshift64*, owned by the battle so its outcome depends only on the seed
+// and the inputs. Spelled out rather than std distributions, which differ
+// between standard libraries.
+struct BattleRng {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    void seed(uint64_t seed);
+    uint32_t next();
+    // Uniform in [0, n)
+    int below(int n);
+};
+
+struct SideState {
+    int hp = 10000;
+    double damage_multiplier = 1.0;
+    CardList deck;
+    CardList hand;
+    Card field[2][6];
+    // Bit row * 6 + col set while that slot holds a live card (hp > 0)
+    uint16_t live = 0;
+    CardList immediate_queue;
+};
+
+inline bool slot_live(uint16_t live, int row, int col) {
+    return (live >> (row * 6 + col)) & 1;
+}
+
+// Bit per column with a live card in either row
+inline uint8_t live_columns(uint16_t live) {
+    return (uint8_t)((live | (live >> 6)) & 0x3F);
+}
+
+// Something that happened in a battle, as plain data; format_battle_event
+// turns it into log text when it's shown
+enum class BattleEventKind : uint8_t {
+    PLACED,
+    QUEUED,
+    ACTIVATED,               // row/col are -1 off the field
+    DESTROYED_ON_ACTIVATION,
+    DESTROYED,
+    ATTACK,                  // target_col -1: amount went to the ship
+    SLOT_DAMAGED,            // no log line; for damage markers
+    SLOT_HEALED,
+    SLOT_MENDED,             // quiet heal: no log line; for heal markers
+    SHIP_DAMAGED,
+    SHIP_HEALED,
+    // Battle screen notes
+    BATTLE_STARTED,
+    REWARD_GAINED,
+    STALEMATE,
+    REPLAY_COPIED,           // amount: turns
+};
+
+struct BattleEvent {
+    BattleEventKind kind = BattleEventKind::BATTLE_STARTED;
+    BattleSide side = BattleSide::PLAYER;
+    int8_t row = -1;
+    int8_t col = -1;
+    int8_t target_col = -1;
+    CardId card = CARD_NONE;
+    int amount = 0;
+};
+
+static constexpr uint32_t BATTLE_EVENT_CAPACITY = 512;
+
+// The most recent BATTLE_EVENT_CAPACITY events. Each event has a sequence
+// number, counting from 0 at the start of the battle.
+struct BattleEventLog {
+    BattleEvent events[BATTLE_EVENT_CAPACITY];
+    uint32_t total = 0;
+
+    void clear() { total = 0; }
+    void push(const BattleEvent& event) { events[total++ % BATTLE_EVENT_CAPACITY] = event; }
+    // Oldest sequence number still held
+    uint32_t first() const { return total > BATTLE_EVENT_CAPACITY ? total - BATTLE_EVENT_CAPACITY : 0; }
+    const BattleEvent& at(uint32_t seq) const { return events[seq % BATTLE_EVENT_CAPACITY]; }
+};
+
+// Plain data throughout, so a battle can be copied with memcpy for
+// search and snapshots
+struct BattleState {
+    SideState player;
+    SideState opponent;
+
+    bool skip_attack_phase = false;
+    int turn = 0;
+    BattleRng rng;
+    // Receives the battle's events when set; headless runs leave it null.
+    // Clear it on copies that shouldn't write to the original's log.
+    BattleEventLog* events = nullptr;
+};
+
+static_assert(std::is_trivially_copyable_v<BattleState>, "BattleState must stay plain data");
+
+// One card played from hand while planning a turn. Normal and special
+// cards go to an empty slot at row/col; immediates are queued and ignore
+// row/col. hand_idx refers to the hand as it is when the action is applied.
+struct PlayAction {
+    int hand_idx;
+    int row;
+    int col;
+};
+
+using TurnInputs = std::vector<PlayAction>;
+
+static constexpr int BATTLE_ATTACK_STEPS = 3;
+// Columns resolved in each attack step, outside in
+extern const int BATTLE_ATTACK_COLS[BATTLE_ATTACK_STEPS][2];
+
+SideState& get_side_state(BattleState& state, BattleSide side);
+const SideState& get_side_state(const BattleState& state, BattleSide side);
+BattleSide opposite_side(BattleSide side);
+const char* side_label(BattleSide side);
+const char* card_kind_label(CardKind kind);
+void battle_event(BattleState& state, const BattleEvent& event);
+// Log text for an event; empty for those without a log line
+std::string format_battle_event(const BattleEvent& event);
+
+// --- Card effect helpers ---------------------------------------------------
+void damage_slot(BattleState& state, BattleSide side, int row, int col, int amount);
+// quiet records SLOT_MENDED instead of SLOT_HEALED
+void heal_slot(BattleState& state, BattleSide side, int row, int col, int amount, bool quiet = false);
+void deal_damage_to_all_slots(BattleState& state, BattleSide side, int amount);
+void heal_all_slots(BattleState& state, BattleSide side, int amount);
+void deal_damage_to_ship(BattleState& state, BattleSide side, int amount);
+void heal_ship(BattleState& state, BattleSide side, int amount);
+void draw_cards(BattleState& state, BattleSide side, int count);
+void card_took_damage_trigger(BattleState& state, BattleSide side, int row, int col, int amount);
+bool random_live_slot(BattleState& state, BattleSide side, int& row, int& col);
+int count_live_cards(const SideState& side);
+
+// --- Targeting ---------------------------------------------------------------
+// Both take the defending side's live mask
+// Column a card in start_col hits on the defending field, or -1
+int find_target_column(uint16_t live, int start_col);
+// Whether a card in start_col with no target column reaches the ship
+bool center_columns_clear(uint16_t live, int start_col);
+int effective_damage(const Card& card, const SideState& side);
+
+// --- Turn flow -------------------------------------------------------------
+// Shuffles both decks, applies field effect cards and deals opening hands.
+// Returns false, leaving state alone, if a deck has more than
+// BATTLE_DECK_CAPACITY cards.
+bool init_battle_state(BattleState& state, const std::vector<CardId>& player_deck,
+                       const std::vector<CardId>& opponent_deck, uint64_t seed);
+bool can_play_card(const BattleState& state, BattleSide side, const PlayAction& action);
+bool play_card(BattleState& state, BattleSide side, const PlayAction& action);
+void apply_turn_inputs(BattleState& state, BattleSide side, const TurnInputs& inputs);
+// Built-in AI: queues every immediate and fills empty slots in order
+TurnInputs plan_turn(const BattleState& state, BattleSide side);
+
+// End of planning: both sides draw, queued immediates resolve. Returns
+// whether the attack steps follow (both ships still alive).
+bool begin_resolution(BattleState& state);
+void resolve_attack_step(BattleState& state, int step);
+// Planning inputs for both sides, then the whole resolution
+void resolve_turn(BattleState& state, const TurnInputs& player, const TurnInputs& opponent);
+
+bool battle_over(const BattleState& state);
+bool is_stalemate(const BattleState& state);
+
+#endif
@@ -0,0 +1,38 @@
+#include "camera.h"
+#include "world.h"
+#include <algorithm>
+#include <cmath>
+
+// Floor division, so negative coordinates land in the right chunk
+static int floor_div(int v, int d) {
+    return v >= 0 ? v / d : -((-v + d - 1) / d);
+}
+
+ViewRect Camera::view_rect(float margin) const {
+    float half_w = aspect / zoom + margin;
+    float half_h = 1.0f / zoom + margin;
+    return {x - half_w, y - half_h, x + half_w, y + half_h};
+}
+
+TileRect Camera::tile_range(float margin) const {
+    ViewRect view = view_rect(margin);
+    // A tile [t, t + 1) is visible if it overlaps the open view rectangle
+    return {(int)std::floor(view.min_x / TILE_SIZE), (int)std::floor(view.min_y / TILE_SIZE),
+            (int)std::ceil(view.max_x / TILE_SIZE) - 1, (int)std::ceil(view.max_y / TILE_SIZE) - 1};
+}
+
+TileRect Camera::chunk_range(float margin) const {
+    TileRect tiles = tile_range(margin);
+    return {floor_div(tiles.min_x, Chunk::SIZE), floor_div(tiles.min_y, Chunk::SIZE),
+            floor_div(tiles.max_x, Chunk::SIZE), floor_div(tiles.max_y, Chunk::SIZE)};
+}
+
+bool Camera::chunk_columns(Point chunk, float margin, int& first, int& last) const {
+    TileRect tiles = tile_range(margin);
+    int origin_x = chunk.first * Chunk::SIZE;
+    int origin_y = chunk.second * Chunk::SIZE;
+    if (tiles.max_y < origin_y || tiles.min_y >= origin_y + Chunk::SIZE) return false;
+    first = std::max(tiles.min_x - origin_x, 0);
+    last = std::min(tiles.max_x - origin_x, Chunk::SIZE - 1);
+    return first <= last;
+}
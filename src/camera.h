@@ -0,0 +1,47 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "chunk.h"
+
+// World-space rectangle, in world units
+struct ViewRect {
+    float min_x, min_y, max_x, max_y;
+};
+
+// Inclusive range of tile or chunk coordinates
+struct TileRect {
+    int min_x, min_y, max_x, max_y;
+
+    int width() const { return max_x - min_x + 1; }
+    int height() const { return max_y - min_y + 1; }
+    bool operator==(const TileRect&) const = default;
+};
+
+// The one definition of what the player can see. The view spans
+// aspect / zoom world units either side of the camera horizontally and
+// 1 / zoom vertically, matching set_camera_view. Margins (world units)
+// grow the rectangle for geometry that overhangs its tile, e.g. planets.
+struct Camera {
+    float x = 0.0f;
+    float y = 0.0f;
+    float aspect = 1.0f;
+    float zoom = 1.0f;
+
+    ViewRect view_rect(float margin = 0.0f) const;
+    // Tiles touching the view rectangle
+    TileRect tile_range(float margin = 0.0f) const;
+    // Chunks containing any of those tiles
+    TileRect chunk_range(float margin = 0.0f) const;
+    // Visible columns (local x) of a chunk; false if none are visible
+    bool chunk_columns(Point chunk, float margin, int& first, int& last) const;
+};
+
+// How much of the active world a frame actually drew
+struct CullStats {
+    int chunks_drawn = 0;
+    int chunks_culled = 0;
+    int tiles_drawn = 0;
+    int tiles_culled = 0;
+};
+
+#endif // CAMERA_H
@@ -1,598 +1,511 @@
 #pragma once
 
-#include "battle.h"
+#include "battle_sim.h"
 
-#include <array>
 #include <algorithm>
-#include <optional>
-#include <random>
+#include <span>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 namespace cards {
 
-inline std::mt19937& card_rng() {
-    static thread_local std::mt19937 rng{std::random_device{}()};
-    return rng;
-}
+// Catalog ids, in the order of DEFS
+enum : CardId {
+    SHIELD,
+    SHIELD_MK2,
+    SHIELD_MK3,
+    TURRET,
+    TURRET_MK2,
+    TURRET_MK3,
+    DRONE,
+    DRONE_MK2,
+    DRONE_MK3,
+    MECHANIC,
+    BOMBARD,
+    ALTERNATOR,
+    OVERHEAT,
+    OVERHEAT_MK2,
+    OVERHEAT_MK3,
+    GREED,
+    GREED_MK2,
+    GREED_MK3,
+    BOMB,
+    BOMB_MK2,
+    CEASEFIRE,
+    BATTLE_DRILLS,
+    REINFORCED_HULL,
+    NANO_SURGE,
+    DAMPENING_FIELD,
+    FRAGILE_LENS,
+    BLURRED_LENS,
+    PIERCING_BEAM,
+    GUARDIAN_ANGEL,
+    REACTOR_OVERDRIVE,
+    LONE_WOLF,
+    MASOCHIST,
+    GLASS_CANNON,
+    COUNT
+};
 
-inline void apply_damage_to_slot(SideState& side, int row, int col, int dmg) {
-    if (dmg <= 0) return;
-    Card& target = side.field[row][col][0];
-    if (target.hp <= 0) return;
-    int applied = std::min(dmg, target.hp);
-    target.hp -= applied;
-    side.slot_last_damage[row][col] += applied;
-    card_took_damage_trigger(side, row, col, applied);
-}
+// Effect step builders for DEFS
+constexpr EffectTarget SELF = EffectTarget::SELF;
+constexpr EffectTarget ENEMY = EffectTarget::ENEMY;
 
-inline void apply_heal_to_slot(SideState& side, int row, int col, int amount) {
-    if (amount <= 0) return;
-    Card& target = side.field[row][col][0];
-    if (target.hp <= 0) return;
-    int before = target.hp;
-    target.hp = std::min(target.max_hp, target.hp + amount);
-    int healed = target.hp - before;
-    if (healed > 0) {
-        side.slot_last_heal[row][col] += healed;
-    }
+constexpr EffectStep step(EffectOp op, EffectTarget target, int amount = 0, int amount2 = 0, double factor = 1.0) {
+    return {op, target, 0, amount, amount2, factor};
 }
-
-inline std::optional<std::pair<int, int>> random_live_slot(SideState& side) {
-    std::vector<std::pair<int, int>> slots;
-    for (int r = 0; r < 2; ++r) {
-        for (int c = 0; c < 6; ++c) {
-            if (!side.field[r][c].empty() && side.field[r][c][0].hp > 0) {
-                slots.emplace_back(r, c);
-            }
-        }
-    }
-    if (slots.empty()) return std::nullopt;
-    std::uniform_int_distribution<size_t> dist(0, slots.size() - 1);
-    return slots[dist(card_rng())];
+constexpr EffectStep heal_slots(EffectTarget target, int amount) { return step(EffectOp::HEAL_SLOTS, target, amount); }
+constexpr EffectStep damage_slots(EffectTarget target, int amount) { return step(EffectOp::DAMAGE_SLOTS, target, amount); }
+constexpr EffectStep heal_random_slot(EffectTarget target, int amount) { return step(EffectOp::HEAL_RANDOM_SLOT, target, amount); }
+constexpr EffectStep heal_random_slot_quietly(EffectTarget target, int amount) {
+    return step(EffectOp::HEAL_RANDOM_SLOT_QUIETLY, target, amount);
 }
-
-inline int count_live_cards(const SideState& side) {
-    int count = 0;
-    for (int r = 0; r < 2; ++r) {
-        for (int c = 0; c < 6; ++c) {
-            if (!side.field[r][c].empty() && side.field[r][c][0].hp > 0 && !side.field[r][c][0].name.empty()) {
-                ++count;
-            }
-        }
-    }
-    return count;
+constexpr EffectStep damage_random_slot(EffectTarget target, int amount) { return step(EffectOp::DAMAGE_RANDOM_SLOT, target, amount); }
+constexpr EffectStep repair_ship(EffectTarget target, int amount) { return step(EffectOp::HEAL_SHIP, target, amount); }
+constexpr EffectStep damage_ship(EffectTarget target, int amount) { return step(EffectOp::DAMAGE_SHIP, target, amount); }
+constexpr EffectStep draw(int count) { return step(EffectOp::DRAW, SELF, count); }
+constexpr EffectStep multiply_damage(EffectTarget target, double factor) { return step(EffectOp::MULTIPLY_DAMAGE, target, 0, 0, factor); }
+constexpr EffectStep skip_attack_phase() { return step(EffectOp::SKIP_ATTACK_PHASE, SELF); }
+constexpr EffectStep fire_every_other_turn() { return step(EffectOp::FIRE_EVERY_OTHER_TURN, SELF); }
+constexpr EffectStep self_destruct() { return step(EffectOp::SELF_DESTRUCT, SELF); }
+constexpr EffectStep scale_with_allies(int dmg_per_other, int hp_per_card) {
+    return step(EffectOp::SCALE_WITH_ALLIES, SELF, dmg_per_other, hp_per_card);
+}
+constexpr EffectStep after_uses(int uses, EffectStep s) {
+    s.after_uses = (uint8_t)uses;
+    return s;
+}
+constexpr CardEffect effect(EffectStep first, EffectStep second = {}) {
+    return {{first, second}};
 }
 
-// Global card definitions (single instances, copied into decks as needed)
-inline Card SHIELD{
-    "Shield", 500, 500, 50, 50, 80, CardType::SHIELD, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card SHIELD_MK2{
-    "Shield Mk2", 900, 900, 80, 80, 300, CardType::SHIELD, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card SHIELD_MK3{
-    "Shield Mk3", 1400, 1400, 120, 120, 600, CardType::SHIELD, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card TURRET{
-    "Turret", 200, 200, 200, 200, 100, CardType::TURRET, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card TURRET_MK2{
-    "Turret Mk2", 260, 260, 320, 320, 340, CardType::TURRET, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card TURRET_MK3{
-    "Turret Mk3", 320, 320, 480, 480, 550, CardType::TURRET, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card DRONE{
-    "Drone", 300, 300, 100, 100, 50, CardType::DRONE, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card DRONE_MK2{
-    "Drone Mk2", 450, 450, 170, 170, 270, CardType::DRONE, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card DRONE_MK3{
-    "Drone Mk3", 620, 620, 240, 240, 430, CardType::DRONE, CardKind::NORMAL, {}, std::nullopt, {}
-};
-inline Card MECHANIC{
-    "Mechanic",
-    320,
-    320,
-    80,
-    80,
-    500,
-    CardType::UTILITY,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& self = get_side_state(st, side);
-        heal_all_slots(self, 100);
+// Global card definitions, indexed by id
+inline constexpr CardDef DEFS[COUNT] = {
+    {SHIELD, "Shield", 500, 50, 80, CardType::SHIELD, CardKind::NORMAL, {}, {}, nullptr},
+    {SHIELD_MK2, "Shield Mk2", 900, 80, 300, CardType::SHIELD, CardKind::NORMAL, {}, {}, nullptr},
+    {SHIELD_MK3, "Shield Mk3", 1400, 120, 600, CardType::SHIELD, CardKind::NORMAL, {}, {}, nullptr},
+    {TURRET, "Turret", 200, 200, 100, CardType::TURRET, CardKind::NORMAL, {}, {}, nullptr},
+    {TURRET_MK2, "Turret Mk2", 260, 320, 340, CardType::TURRET, CardKind::NORMAL, {}, {}, nullptr},
+    {TURRET_MK3, "Turret Mk3", 320, 480, 550, CardType::TURRET, CardKind::NORMAL, {}, {}, nullptr},
+    {DRONE, "Drone", 300, 100, 50, CardType::DRONE, CardKind::NORMAL, {}, {}, nullptr},
+    {DRONE_MK2, "Drone Mk2", 450, 170, 270, CardType::DRONE, CardKind::NORMAL, {}, {}, nullptr},
+    {DRONE_MK3, "Drone Mk3", 620, 240, 430, CardType::DRONE, CardKind::NORMAL, {}, {}, nullptr},
+    {
+        MECHANIC,
+        "Mechanic",
+        320,
+        80,
+        500,
+        CardType::UTILITY,
+        CardKind::SPECIAL,
+        effect(heal_slots(SELF, 100)),
+        {},
+        "Heal all friendly units by 100 HP"
     },
-    "Heal all friendly units by 100 HP",
-    {}
-};
-inline Card BOMBARD{
-    "Bombard",
-    220,
-    220,
-    150,
-    150,
-    800,
-    CardType::TURRET,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& enemy = get_side_state(st, opposite_side(side));
-        deal_damage_to_all_slots(enemy, 100);
+    {
+        BOMBARD,
+        "Bombard",
+        220,
+        150,
+        800,
+        CardType::TURRET,
+        CardKind::SPECIAL,
+        effect(damage_slots(ENEMY, 100)),
+        {},
+        "Damage all enemy units by 100 HP"
     },
-    "Damage all enemy units by 100 HP",
-    {}
-};
-inline Card ALTERNATOR{
-    "Alternator",
-    240,
-    240,
-    400,
-    400,
-    350,
-    CardType::TURRET,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int row, int col) {
-        SideState& self = get_side_state(st, side);
-        Card& card = self.field[row][col][0];
-        if ((card.state.times_used % 2) == 0) {
-            card.state.skip_this_turn = true; // fires every other turn
-        }
+    {
+        ALTERNATOR,
+        "Alternator",
+        240,
+        400,
+        350,
+        CardType::TURRET,
+        CardKind::SPECIAL,
+        effect(fire_every_other_turn()),
+        {},
+        "Fires only every other turn"
     },
-    "Fires only every other turn",
-    {}
-};
-inline Card OVERHEAT{
-    "Overheat",
-    260,
-    260,
-    180,
-    180,
-    300,
-    CardType::DRONE,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int row, int col) {
-        SideState& self = get_side_state(st, side);
-        Card& card = self.field[row][col][0];
-        if (card.state.times_used >= 3) {
-            card.hp = 0; // destroy after 3 uses
-        }
+    {
+        OVERHEAT,
+        "Overheat",
+        260,
+        180,
+        300,
+        CardType::DRONE,
+        CardKind::SPECIAL,
+        effect(after_uses(3, self_destruct())),
+        {},
+        "Self-destructs after attacking 3 times"
     },
-    "Self-destructs after attacking 3 times",
-    {}
-};
-inline Card OVERHEAT_MK2{
-    "Overheat Mk2",
-    300,
-    300,
-    240,
-    240,
-    500,
-    CardType::DRONE,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int row, int col) {
-        SideState& self = get_side_state(st, side);
-        Card& card = self.field[row][col][0];
-        if (card.state.times_used >= 3) {
-            SideState& enemy = get_side_state(st, opposite_side(side));
-            auto target_slot = random_live_slot(enemy);
-            if (target_slot) {
-                apply_damage_to_slot(enemy, target_slot->first, target_slot->second, 1000);
-            }
-            card.hp = 0;
-        }
+    {
+        OVERHEAT_MK2,
+        "Overheat Mk2",
+        300,
+        240,
+        500,
+        CardType::DRONE,
+        CardKind::SPECIAL,
+        effect(after_uses(3, damage_random_slot(ENEMY, 1000)), after_uses(3, self_destruct())),
+        {},
+        "After 3 attacks, explodes for 1000 damage to a random enemy card"
     },
-    "After 3 attacks, explodes for 1000 damage to a random enemy card",
-    {}
-};
-inline Card OVERHEAT_MK3{
-    "Overheat Mk3",
-    340,
-    340,
-    260,
-    260,
-    650,
-    CardType::DRONE,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int row, int col) {
-        SideState& self = get_side_state(st, side);
-        Card& card = self.field[row][col][0];
-        if (card.state.times_used >= 3) {
-            SideState& enemy = get_side_state(st, opposite_side(side));
-            deal_damage_to_all_slots(enemy, 1000);
-            card.hp = 0;
-        }
+    {
+        OVERHEAT_MK3,
+        "Overheat Mk3",
+        340,
+        260,
+        650,
+        CardType::DRONE,
+        CardKind::SPECIAL,
+        effect(after_uses(3, damage_slots(ENEMY, 1000)), after_uses(3, self_destruct())),
+        {},
+        "After 3 attacks, explodes for 1000 damage to all enemy cards"
     },
-    "After 3 attacks, explodes for 1000 damage to all enemy cards",
-    {}
-};
-inline Card GREED{
-    "Greed",
-    0,
-    0,
-    0,
-    0,
-    130,
-    CardType::UTILITY,
-    CardKind::IMMEDIATE,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& self = get_side_state(st, side);
-        for (int i = 0; i < 2 && !self.deck.empty(); ++i) {
-            self.hand.push_back(self.deck.back());
-            self.deck.pop_back();
-        }
+    {
+        GREED,
+        "Greed",
+        0,
+        0,
+        130,
+        CardType::UTILITY,
+        CardKind::IMMEDIATE,
+        effect(draw(2)),
+        {},
+        "Draw 2 more cards"
     },
-    "Draw 2 more cards",
-    {}
-};
-inline Card GREED_MK2{
-    "Greed Mk2",
-    0,
-    0,
-    0,
-    0,
-    200,
-    CardType::UTILITY,
-    CardKind::IMMEDIATE,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& self = get_side_state(st, side);
-        for (int i = 0; i < 3 && !self.deck.empty(); ++i) {
-            self.hand.push_back(self.deck.back());
-            self.deck.pop_back();
-        }
+    {
+        GREED_MK2,
+        "Greed Mk2",
+        0,
+        0,
+        200,
+        CardType::UTILITY,
+        CardKind::IMMEDIATE,
+        effect(draw(3)),
+        {},
+        "Draw 3 more cards"
     },
-    "Draw 3 more cards",
-    {}
-};
-inline Card GREED_MK3{
-    "Greed Mk3",
-    0,
-    0,
-    0,
-    0,
-    260,
-    CardType::UTILITY,
-    CardKind::IMMEDIATE,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& self = get_side_state(st, side);
-        for (int i = 0; i < 4 && !self.deck.empty(); ++i) {
-            self.hand.push_back(self.deck.back());
-            self.deck.pop_back();
-        }
+    {
+        GREED_MK3,
+        "Greed Mk3",
+        0,
+        0,
+        260,
+        CardType::UTILITY,
+        CardKind::IMMEDIATE,
+        effect(draw(4)),
+        {},
+        "Draw 4 more cards"
     },
-    "Draw 4 more cards",
-    {}
-};
-inline Card BOMB{
-    "Bomb",
-    0,
-    0,
-    0,
-    0,
-    170,
-    CardType::UTILITY,
-    CardKind::IMMEDIATE,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& enemy = get_side_state(st, opposite_side(side));
-        deal_damage_to_all_slots(enemy, 100);
-        deal_damage_to_ship(enemy, 50);
+    {
+        BOMB,
+        "Bomb",
+        0,
+        0,
+        170,
+        CardType::UTILITY,
+        CardKind::IMMEDIATE,
+        effect(damage_slots(ENEMY, 100), damage_ship(ENEMY, 50)),
+        {},
+        "Deal 100 to all enemy units and 50 to the enemy ship"
     },
-    "Deal 100 to all enemy units and 50 to the enemy ship",
-    {}
-};
-inline Card BOMB_MK2{
-    "Bomb Mk2",
-    0,
-    0,
-    0,
-    0,
-    350,
-    CardType::UTILITY,
-    CardKind::IMMEDIATE,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& enemy = get_side_state(st, opposite_side(side));
-        SideState& self = get_side_state(st, side);
-        deal_damage_to_all_slots(enemy, 500);
-        deal_damage_to_all_slots(self, 100);
+    {
+        BOMB_MK2,
+        "Bomb Mk2",
+        0,
+        0,
+        350,
+        CardType::UTILITY,
+        CardKind::IMMEDIATE,
+        effect(damage_slots(ENEMY, 500), damage_slots(SELF, 100)),
+        {},
+        "Deal 500 to all enemy units and 100 to all friendly units"
     },
-    "Deal 500 to all enemy units and 100 to all friendly units",
-    {}
-};
-inline Card CEASEFIRE{
-    "Ceasefire",
-    0,
-    0,
-    0,
-    0,
-    80,
-    CardType::UTILITY,
-    CardKind::IMMEDIATE,
-    [](BattleState& st, BattleSide, int, int) {
-        st.skip_attack_phase = true;
+    {
+        CEASEFIRE,
+        "Ceasefire",
+        0,
+        0,
+        80,
+        CardType::UTILITY,
+        CardKind::IMMEDIATE,
+        effect(skip_attack_phase()),
+        {},
+        "End the attack phase for this turn"
     },
-    "End the attack phase for this turn",
-    {}
-};
-inline Card BATTLE_DRILLS{
-    "Battle Drills",
-    0,
-    0,
-    0,
-    0,
-    2000,
-    CardType::TURRET,
-    CardKind::FIELD_EFFECT,
-    [](BattleState& st, BattleSide side, int, int) {
-        get_side_state(st, side).damage_multiplier *= 1.5;
+    {
+        BATTLE_DRILLS,
+        "Battle Drills",
+        0,
+        0,
+        2000,
+        CardType::TURRET,
+        CardKind::FIELD_EFFECT,
+        effect(multiply_damage(SELF, 1.5)),
+        {},
+        "Increases your cards' damage by 50% (mult)"
     },
-    "Increases your cards' damage by 50% (mult)",
-    {}
-};
-inline Card REINFORCED_HULL{
-    "Reinforced Hull",
-    0,
-    0,
-    0,
-    0,
-    1000,
-    CardType::SHIELD,
-    CardKind::FIELD_EFFECT,
-    [](BattleState& st, BattleSide side, int, int) {
-        heal_ship(get_side_state(st, side), 1000);
+    {
+        REINFORCED_HULL,
+        "Reinforced Hull",
+        0,
+        0,
+        1000,
+        CardType::SHIELD,
+        CardKind::FIELD_EFFECT,
+        effect(repair_ship(SELF, 1000)),
+        {},
+        "Increase ship HP by 1000"
     },
-    "Increase ship HP by 1000",
-    {}
-};
-inline Card NANO_SURGE{
-    "Nano Surge",
-    0,
-    0,
-    0,
-    0,
-    1000,
-    CardType::UTILITY,
-    CardKind::IMMEDIATE,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& self = get_side_state(st, side);
-        heal_ship(self, 300);
-        heal_all_slots(self, 50);
+    {
+        NANO_SURGE,
+        "Nano Surge",
+        0,
+        0,
+        1000,
+        CardType::UTILITY,
+        CardKind::IMMEDIATE,
+        effect(repair_ship(SELF, 300), heal_slots(SELF, 50)),
+        {},
+        "Heal ship by 300 and all friendly units by 50"
     },
-    "Heal ship by 300 and all friendly units by 50",
-    {}
-};
-inline Card DAMPENING_FIELD{
-    "Dampening Field",
-    0,
-    0,
-    0,
-    0,
-    1500,
-    CardType::UTILITY,
-    CardKind::FIELD_EFFECT,
-    [](BattleState& st, BattleSide side, int, int) {
-        // Reduce incoming damage by lowering the opponent's damage multiplier
-        get_side_state(st, opposite_side(side)).damage_multiplier *= 0.85;
+    {
+        DAMPENING_FIELD,
+        "Dampening Field",
+        0,
+        0,
+        1500,
+        CardType::UTILITY,
+        CardKind::FIELD_EFFECT,
+        effect(multiply_damage(ENEMY, 0.85)),
+        {},
+        "Reduce incoming damage taken by 15%"
     },
-    "Reduce incoming damage taken by 15%",
-    {}
-};
-inline Card FRAGILE_LENS{
-    "Fragile Lens",
-    50,
-    50,
-    40,
-    40,
-    300,
-    CardType::UTILITY,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& self = get_side_state(st, side);
-        self.damage_multiplier *= 1.2;
+    {
+        FRAGILE_LENS,
+        "Fragile Lens",
+        50,
+        40,
+        300,
+        CardType::UTILITY,
+        CardKind::SPECIAL,
+        effect(multiply_damage(SELF, 1.2)),
+        {},
+        "Each turn on the field, increase your damage multiplier by 10%"
     },
-    "Each turn on the field, increase your damage multiplier by 10%",
-    {}
-};
-inline Card BLURRED_LENS{
-    "Blurred Lens",
-    50,
-    50,
-    40,
-    40,
-    320,
-    CardType::UTILITY,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& enemy = get_side_state(st, opposite_side(side));
-        enemy.damage_multiplier *= 0.8;
+    {
+        BLURRED_LENS,
+        "Blurred Lens",
+        50,
+        40,
+        320,
+        CardType::UTILITY,
+        CardKind::SPECIAL,
+        effect(multiply_damage(ENEMY, 0.8)),
+        {},
+        "Each turn on the field, reduce the opponent's damage multiplier by 10%"
     },
-    "Each turn on the field, reduce the opponent's damage multiplier by 10%",
-    {}
-};
-inline Card PIERCING_BEAM{
-    "Piercing Beam",
-    240,
-    240,
-    260,
-    260,
-    600,
-    CardType::TURRET,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& enemy = get_side_state(st, opposite_side(side));
-        deal_damage_to_ship(enemy, 100);
+    {
+        PIERCING_BEAM,
+        "Piercing Beam",
+        240,
+        260,
+        600,
+        CardType::TURRET,
+        CardKind::SPECIAL,
+        effect(damage_ship(ENEMY, 100)),
+        {},
+        "Each attack also deals 100 damage to the enemy ship"
     },
-    "Each attack also deals 100 damage to the enemy ship",
-    {}
-};
-inline Card GUARDIAN_ANGEL{
-    "Guardian Angel",
-    520,
-    520,
-    100,
-    100,
-    380,
-    CardType::SHIELD,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& self = get_side_state(st, side);
-        auto slot = random_live_slot(self);
-        if (slot) {
-            apply_heal_to_slot(self, slot->first, slot->second, 120);
-        }
+    {
+        GUARDIAN_ANGEL,
+        "Guardian Angel",
+        520,
+        100,
+        380,
+        CardType::SHIELD,
+        CardKind::SPECIAL,
+        effect(heal_random_slot_quietly(SELF, 120)),
+        {},
+        "Heals a random friendly unit by 120 each turn it's on the field"
     },
-    "Heals a random friendly unit by 120 each turn it's on the field",
-    {}
-};
-inline Card REACTOR_OVERDRIVE{
-    "Reactor Overdrive",
-    0,
-    0,
-    0,
-    0,
-    2200,
-    CardType::UTILITY,
-    CardKind::FIELD_EFFECT,
-    [](BattleState& st, BattleSide side, int, int) {
-        SideState& self = get_side_state(st, side);
-        self.damage_multiplier *= 1.25;
-        deal_damage_to_ship(self, 400);
+    {
+        REACTOR_OVERDRIVE,
+        "Reactor Overdrive",
+        0,
+        0,
+        2200,
+        CardType::UTILITY,
+        CardKind::FIELD_EFFECT,
+        effect(multiply_damage(SELF, 1.25), damage_ship(SELF, 400)),
+        {},
+        "Boost your damage by 25% but deal 400 damage to your ship"
     },
-    "Boost your damage by 25% but deal 400 damage to your ship",
-    {}
-};
-inline Card LONE_WOLF{
-    "Lone Wolf",
-    1000,
-    1000,
-    6000,
-    6000,
-    1600,
-    CardType::TURRET,
-    CardKind::SPECIAL,
-    [](BattleState& st, BattleSide side, int row, int col) {
-        SideState& self = get_side_state(st, side);
-        int live = count_live_cards(self);
-        int other = std::max(0, live - 1);
-        Card& card = self.field[row][col][0];
-        int new_dmg = std::max(1, 6000 - 2000 * other);
-        card.dmg = new_dmg;
-        card.base_dmg = new_dmg;
-        int new_hp_cap = std::max(1, 1000 - 333 * live);
-        card.max_hp = new_hp_cap;
-        if (card.hp > new_hp_cap) card.hp = new_hp_cap;
+    {
+        LONE_WOLF,
+        "Lone Wolf",
+        1000,
+        6000,
+        1600,
+        CardType::TURRET,
+        CardKind::SPECIAL,
+        effect(scale_with_allies(2000, 333)),
+        {},
+        "Damage 6000 minus 2000 per other friendly card; HP 1000 minus 333 per friendly card (min 1)"
     },
-    "Damage 6000 minus 2000 per other friendly card; HP 1000 minus 333 per friendly card (min 1)",
-    {}
-};
-inline Card MASOCHIST{
-    "Masochist",
-    800,
-    800,
-    150,
-    150,
-    350,
-    CardType::SHIELD,
-    CardKind::NORMAL,
-    {},
-    "When it takes damage, heal your ship by 500",
-    {}
-};
-inline Card GLASS_CANNON{
-    "Glass Cannon",
-    0,
-    0,
-    0,
-    0,
-    900,
-    CardType::UTILITY,
-    CardKind::IMMEDIATE,
-    [](BattleState& st, BattleSide side, int, int) {
-        get_side_state(st, side).damage_multiplier *= 3.0;
-        get_side_state(st, opposite_side(side)).damage_multiplier *= 3.0;
+    {
+        MASOCHIST,
+        "Masochist",
+        800,
+        150,
+        350,
+        CardType::SHIELD,
+        CardKind::NORMAL,
+        {},
+        effect(repair_ship(SELF, 500)),
+        "When it takes damage, heal your ship by 500"
+    },
+    {
+        GLASS_CANNON,
+        "Glass Cannon",
+        0,
+        0,
+        900,
+        CardType::UTILITY,
+        CardKind::IMMEDIATE,
+        effect(multiply_damage(SELF, 3.0), multiply_damage(ENEMY, 3.0)),
+        {},
+        "Immediately triples both sides' damage multipliers"
     },
-    "Immediately triples both sides' damage multipliers",
-    {}
 };
 
-inline const std::array ALL{
-    &SHIELD,
-    &SHIELD_MK2,
-    &SHIELD_MK3,
-    &TURRET,
-    &TURRET_MK2,
-    &TURRET_MK3,
-    &DRONE,
-    &DRONE_MK2,
-    &DRONE_MK3,
-    &MECHANIC,
-    &BOMBARD,
-    &ALTERNATOR,
-    &OVERHEAT,
-    &OVERHEAT_MK2,
-    &OVERHEAT_MK3,
-    &GREED,
-    &GREED_MK2,
-    &GREED_MK3,
-    &BOMB,
-    &BOMB_MK2,
-    &CEASEFIRE,
-    &BATTLE_DRILLS,
-    &REINFORCED_HULL,
-    &NANO_SURGE,
-    &DAMPENING_FIELD,
-    &FRAGILE_LENS,
-    &BLURRED_LENS,
-    &PIERCING_BEAM,
-    &GUARDIAN_ANGEL,
-    &REACTOR_OVERDRIVE,
-    &LONE_WOLF,
-    &MASOCHIST,
-    &GLASS_CANNON,
-};
+static_assert([] {
+    for (int i = 0; i < COUNT; ++i) {
+        if (DEFS[i].id != i) return false;
+    }
+    return true;
+}(), "DEFS must be in id order");
 
-inline const std::vector<std::pair<const Card*, int>> DEFAULT_DECKLIST{
-    {&SHIELD, 1},
-    {&TURRET, 2},
-    {&DRONE, 1},
-    {&MECHANIC, 1},
-    {&OVERHEAT_MK2, 1},
-    {&GREED, 1},
-    {&BOMB, 1},
-    {&BOMB_MK2, 1},
-    {&FRAGILE_LENS, 1},
-    {&GLASS_CANNON, 1},
+inline const std::vector<std::pair<CardId, int>> DEFAULT_DECKLIST{
+    {SHIELD, 1},
+    {TURRET, 2},
+    {DRONE, 1},
+    {MECHANIC, 1},
+    {OVERHEAT_MK2, 1},
+    {GREED, 1},
+    {BOMB, 1},
+    {BOMB_MK2, 1},
+    {FRAGILE_LENS, 1},
+    {GLASS_CANNON, 1},
 };
 
 inline const auto& all() {
-    return ALL;
+    return DEFS;
 }
 
-inline const Card* find_by_name(std::string_view name) {
-    for (const Card* card : ALL) {
-        if (card->name == name) return card;
+// --- Catalog indexes, built at compile time ----------------------------------
+
+// Slots in the name table; twice the catalog keeps the seed search short
+inline constexpr int NAME_SLOTS = 128;
+static_assert(COUNT <= NAME_SLOTS / 2, "grow NAME_SLOTS with the catalog");
+
+constexpr uint32_t name_hash(std::string_view name, uint32_t seed) {
+    uint32_t h = 0x811C9DC5u ^ seed;
+    for (char ch : name) {
+        h ^= (uint8_t)ch;
+        h *= 0x01000193u;
     }
-    return nullptr;
+    // FNV's low bits only see the low bits of the seed; mix before the modulo
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
 }
 
-inline const std::vector<std::pair<const Card*, int>>& default_decklist() {
+struct Catalog {
+    // Ids by ascending cost, ties in id order, with their costs alongside
+    CardId by_cost[COUNT];
+    int sorted_cost[COUNT];
+    // Perfect hash: name_hash(name, name_seed) % NAME_SLOTS is distinct
+    // for every card
+    uint32_t name_seed;
+    CardId name_slots[NAME_SLOTS];
+};
+
+constexpr Catalog make_catalog() {
+    Catalog catalog{};
+    int count = 0;
+    for (int i = 0; i < COUNT; ++i) {
+        int at = count++;
+        for (; at > 0 && catalog.sorted_cost[at - 1] > DEFS[i].cost; --at) {
+            catalog.by_cost[at] = catalog.by_cost[at - 1];
+            catalog.sorted_cost[at] = catalog.sorted_cost[at - 1];
+        }
+        catalog.by_cost[at] = (CardId)i;
+        catalog.sorted_cost[at] = DEFS[i].cost;
+    }
+
+    for (uint32_t seed = 0;; ++seed) {
+        for (CardId& slot : catalog.name_slots) slot = CARD_NONE;
+        bool collided = false;
+        for (int i = 0; i < COUNT && !collided; ++i) {
+            CardId& slot = catalog.name_slots[name_hash(DEFS[i].name, seed) % NAME_SLOTS];
+            collided = slot != CARD_NONE;
+            slot = (CardId)i;
+        }
+        if (!collided) {
+            catalog.name_seed = seed;
+            return catalog;
+        }
+    }
+}
+
+inline constexpr Catalog CATALOG = make_catalog();
+
+// Every card costing less than cost, cheapest first
+inline std::span<const CardId> cheaper_than(int cost) {
+    const int* end = std::lower_bound(CATALOG.sorted_cost, CATALOG.sorted_cost + COUNT, cost);
+    return {CATALOG.by_cost, (size_t)(end - CATALOG.sorted_cost)};
+}
+
+inline const CardDef* find_by_name(std::string_view name) {
+    CardId id = CATALOG.name_slots[name_hash(name, CATALOG.name_seed) % NAME_SLOTS];
+    if (id == CARD_NONE || DEFS[id].name != name) return nullptr;
+    return &DEFS[id];
+}
+
+inline const std::vector<std::pair<CardId, int>>& default_decklist() {
     return DEFAULT_DECKLIST;
 }
 
-inline std::vector<Card> generate_deck_with_cost(int cost_limit) {
-    std::vector<Card> deck;
-    if (cost_limit <= 0 || ALL.empty()) return deck;
+inline std::vector<CardId> default_deck() {
+    std::vector<CardId> deck;
+    for (const auto& [id, copies] : DEFAULT_DECKLIST) {
+        for (int i = 0; i < copies; ++i) deck.push_back(id);
+    }
+    return deck;
+}
+
+inline constexpr int MEAN_COST = [] {
+    int total = 0;
+    for (const CardDef& def : DEFS) total += def.cost;
+    return std::max(1, total / COUNT);
+}();
 
-    static thread_local std::mt19937 rng{std::random_device{}()};
-    std::uniform_int_distribution<size_t> dist(0, ALL.size() - 1);
+// Random cards until the total cost passes cost_limit or the deck reaches
+// BATTLE_DECK_CAPACITY
+inline std::vector<CardId> generate_deck_with_cost(int cost_limit, BattleRng& rng) {
+    std::vector<CardId> deck;
+    if (cost_limit <= 0) return deck;
+    deck.reserve(std::min(cost_limit / MEAN_COST + 2, BATTLE_DECK_CAPACITY));
 
     int total_cost = 0;
-    while (total_cost <= cost_limit) {
-        const Card* drawn = ALL[dist(rng)];
-        if (!drawn) continue;
-        deck.push_back(*drawn);
-        total_cost += drawn->cost;
+    while (total_cost <= cost_limit && (int)deck.size() < BATTLE_DECK_CAPACITY) {
+        CardId drawn = (CardId)rng.below(COUNT);
+        deck.push_back(drawn);
+        total_cost += DEFS[drawn].cost;
     }
     return deck;
 }
@@ -0,0 +1,15 @@
+#include "chunk.h"
+
+Chunk::Chunk() {
+    for (int x = 0; x < SIZE; ++x) {
+        for (int y = 0; y < SIZE; ++y) {
+            tiles[x][y] = Tiles::EMPTY;
+        }
+    }
+}
+Tiles Chunk::get_tile(int x, int y) const {
+    if (x < 0 || x >= SIZE || y < 0 || y >= SIZE) {
+        return Tiles::EMPTY;
+    }
+    return tiles[x][y];
+}
@@ -0,0 +1,33 @@
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+using Point = std::pair<int, int>;
+
+enum class Tiles {
+    EMPTY,
+    DANGEROUS,
+    PLANET,
+    ASTEROID,
+    SHOP,
+    RESOURCES
+};
+class Chunk {
+public:
+    static const int SIZE = 16;
+    Tiles tiles[SIZE][SIZE];
+
+    Chunk();
+    Tiles get_tile(int x, int y) const;
+};
+struct PointHash {
+    inline size_t operator()(const Point & v) const {
+        // A simple hash combination algorithm
+        return std::hash<int>{}(v.first) ^ (std::hash<int>{}(v.second) << 1);
+    }
+};
+
+#endif // CHUNK_H
@@ -0,0 +1,192 @@
+#include "chunk_mesh.h"
+#include "world.h"
+#include <algorithm>
+#include <cmath>
+
+static const int DISC_SEGMENTS = 30;
+
+static GLubyte to_byte(float v) {
+    return (GLubyte)std::lround(std::min(std::max(v, 0.0f), 1.0f) * 255.0f);
+}
+
+static void push_vertex(std::vector<ColorVertex>& out, float x, float y, float r, float g, float b, float a) {
+    out.push_back({x, y, to_byte(r), to_byte(g), to_byte(b), to_byte(a)});
+}
+
+static void push_square(std::vector<ColorVertex>& out, float x, float y, float size, float r, float g, float b, float a) {
+    push_vertex(out, x, y, r, g, b, a);
+    push_vertex(out, x + size, y, r, g, b, a);
+    push_vertex(out, x + size, y + size, r, g, b, a);
+    push_vertex(out, x, y, r, g, b, a);
+    push_vertex(out, x + size, y + size, r, g, b, a);
+    push_vertex(out, x, y + size, r, g, b, a);
+}
+
+static void push_disc(std::vector<ColorVertex>& out, float cx, float cy, float radius, float r, float g, float b) {
+    // Same outline as circleVbo, unrolled from a fan into triangles
+    for (int i = 0; i < DISC_SEGMENTS; ++i) {
+        float a0 = 2.0f * M_PI * float(i) / DISC_SEGMENTS;
+        float a1 = 2.0f * M_PI * float(i + 1) / DISC_SEGMENTS;
+        push_vertex(out, cx, cy, r, g, b, 1.0f);
+        push_vertex(out, cx + radius * cos(a0), cy + radius * sin(a0), r, g, b, 1.0f);
+        push_vertex(out, cx + radius * cos(a1), cy + radius * sin(a1), r, g, b, 1.0f);
+    }
+}
+
+void ChunkMeshCache::build_vertices(const Chunk& chunk, std::vector<ColorVertex>& out, GLint column_first[]) {
+    out.clear();
+    // Same order and look as draw_tile, so overlaps blend identically
+    for (int x = 0; x < Chunk::SIZE; ++x) {
+        column_first[x] = (GLint)out.size();
+        for (int y = 0; y < Chunk::SIZE; ++y) {
+            float tx = x * TILE_SIZE;
+            float ty = y * TILE_SIZE;
+            switch (chunk.get_tile(x, y)) {
+                case Tiles::PLANET:
+                    push_disc(out, tx + 0.5f * TILE_SIZE, ty + 0.5f * TILE_SIZE, 0.9f, 0.0f, 0.5f, 1.0f);
+                    break;
+                case Tiles::ASTEROID:
+                    push_disc(out, tx + 0.5f * TILE_SIZE, ty + 0.5f * TILE_SIZE, 0.1f, 0.5f, 0.5f, 0.5f);
+                    break;
+                case Tiles::DANGEROUS:
+                    push_square(out, tx, ty, TILE_SIZE, 1.0f, 0.0f, 0.0f, 0.3f);
+                    break;
+                case Tiles::RESOURCES:
+                    push_square(out, tx, ty, TILE_SIZE, 0.5f, 0.5f, 0.0f, 1.0f);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    column_first[Chunk::SIZE] = (GLint)out.size();
+}
+
+ChunkMeshCache::~ChunkMeshCache() {
+    clear();
+}
+
+void ChunkMeshCache::clear() {
+    while (meshes.live_count() > 0) {
+        ChunkMesh* mesh = meshes.live_at(meshes.live_count() - 1);
+        glDeleteBuffers(1, &mesh->vbo);
+        meshes.destroy(mesh);
+    }
+    std::fill(index.begin(), index.end(), nullptr);
+    draw_order.clear();
+}
+
+static size_t index_slot(Point coord, size_t mask) {
+    uint64_t h = PointHash{}(coord);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h & mask;
+}
+
+ChunkMesh* ChunkMeshCache::find(Point coord) const {
+    if (index.empty()) return nullptr;
+    size_t mask = index.size() - 1;
+    for (size_t i = index_slot(coord, mask);; i = (i + 1) & mask) {
+        ChunkMesh* mesh = index[i];
+        if (!mesh || mesh->coord == coord) return mesh;
+    }
+}
+
+void ChunkMeshCache::insert(ChunkMesh* mesh) {
+    size_t mask = index.size() - 1;
+    size_t i = index_slot(mesh->coord, mask);
+    while (index[i]) i = (i + 1) & mask;
+    index[i] = mesh;
+}
+
+void ChunkMeshCache::rebuild_index(size_t expected) {
+    size_t capacity = index.empty() ? 64 : index.size();
+    while (capacity < expected * 2) capacity *= 2;
+    // Only ever grows, so steady streaming reuses the same table
+    index.assign(capacity, nullptr);
+    for (size_t i = 0; i < meshes.live_count(); ++i) insert(meshes.live_at(i));
+}
+
+void ChunkMeshCache::sync(const std::vector<std::pair<Point, const Chunk*>>& active) {
+    unsigned tag = ++sync_counter;
+    if (index.size() < (meshes.live_count() + active.size()) * 2) {
+        rebuild_index(meshes.live_count() + active.size());
+    }
+    draw_order.clear();
+    for (const auto& [coord, chunk] : active) {
+        if (ChunkMesh* existing = find(coord)) {
+            existing->sync_tag = tag;
+            draw_order.push_back(existing);
+            continue;
+        }
+
+        ChunkMesh* mesh = meshes.create();
+        mesh->coord = coord;
+        build_vertices(*chunk, scratch, mesh->column_first);
+        mesh->sync_tag = tag;
+        mesh->vertex_count = (GLsizei)scratch.size();
+        if (!scratch.empty()) {
+            glGenBuffers(1, &mesh->vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+            glBufferData(GL_ARRAY_BUFFER, scratch.size() * sizeof(ColorVertex), scratch.data(), GL_STATIC_DRAW);
+        }
+        insert(mesh);
+        draw_order.push_back(mesh);
+    }
+
+    // Release meshes that left the active set; their slots go back to the pool
+    size_t released = 0;
+    for (size_t i = 0; i < meshes.live_count();) {
+        ChunkMesh* mesh = meshes.live_at(i);
+        if (mesh->sync_tag != tag) {
+            glDeleteBuffers(1, &mesh->vbo);
+            meshes.destroy(mesh); // swap-removes, so i now holds another mesh
+            ++released;
+        } else {
+            ++i;
+        }
+    }
+    if (released > 0) rebuild_index(meshes.live_count());
+}
+
+void ChunkMeshCache::draw(GLuint program, const Camera& camera) {
+    last_draw_calls = 0;
+    last_cull = CullStats{};
+    for (const ChunkMesh* mesh_ptr : draw_order) {
+        const ChunkMesh& mesh = *mesh_ptr;
+        const Point& coord = mesh.coord;
+        int first_column, last_column;
+        if (!camera.chunk_columns(coord, TILE_OVERHANG, first_column, last_column)) {
+            last_cull.chunks_culled++;
+            last_cull.tiles_culled += Chunk::SIZE * Chunk::SIZE;
+            continue;
+        }
+        int visible_tiles = (last_column - first_column + 1) * Chunk::SIZE;
+        last_cull.chunks_drawn++;
+        last_cull.tiles_drawn += visible_tiles;
+        last_cull.tiles_culled += Chunk::SIZE * Chunk::SIZE - visible_tiles;
+
+        GLint first = mesh.column_first[first_column];
+        GLsizei count = mesh.column_first[last_column + 1] - first;
+        if (count == 0) continue;
+
+        // Chunk origin relative to the camera anchor, small and exact
+        const CameraAnchor& anchor = get_camera_anchor();
+        float localX = coord.first * Chunk::SIZE * TILE_SIZE - anchor.x;
+        float localY = coord.second * Chunk::SIZE * TILE_SIZE - anchor.y;
+
+        DrawCommand cmd;
+        cmd.program = program;
+        cmd.vbo = mesh.vbo;
+        cmd.layout = VertexLayout::POSITION_COLOR;
+        cmd.blend = true;
+        cmd.mode = GL_TRIANGLES;
+        cmd.first = first;
+        cmd.count = count;
+        cmd.camera_space = true;
+        make_transform(cmd.transform, localX, localY, 1.0f, 1.0f);
+        submit_draw(cmd);
+        ++last_draw_calls;
+    }
+}
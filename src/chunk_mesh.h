@@ -0,0 +1,60 @@
+#ifndef CHUNK_MESH_H
+#define CHUNK_MESH_H
+
+#include "gl.h"
+#include <utility>
+#include <vector>
+#include "camera.h"
+#include "chunk.h"
+#include "geometry.h"
+#include "slab_pool.h"
+
+// Static GPU mesh of one chunk, in chunk-local tile units. Vertices are
+// laid out column by column, so any run of visible columns is one range.
+struct ChunkMesh {
+    Point coord;
+    GLuint vbo = 0;
+    GLsizei vertex_count = 0;
+    GLint column_first[Chunk::SIZE + 1] = {}; // first vertex of each column, plus the end
+    unsigned sync_tag = 0;
+};
+
+// Keeps a baked vertex buffer for every active chunk. Chunks are meshed
+// once when they become active (chunks are immutable once generated) and
+// released when they leave the active set, so each chunk draws with one
+// glDrawArrays and a transform. Meshes live in a slab pool like the chunks
+// themselves, so streaming recycles their slots instead of allocating.
+class ChunkMeshCache {
+public:
+    ~ChunkMeshCache();
+
+    // Meshes newly active chunks and frees meshes of chunks that left
+    void sync(const std::vector<std::pair<Point, const Chunk*>>& active);
+    // Records one camera-space draw command per visible chunk, covering
+    // only its visible columns; program needs `position`, `color`
+    // attributes and `transform`, `view` uniforms
+    void draw(GLuint program, const Camera& camera);
+    void clear();
+
+    size_t size() const { return meshes.live_count(); }
+    size_t draw_calls() const { return last_draw_calls; }
+    const CullStats& cull_stats() const { return last_cull; }
+
+private:
+    static void build_vertices(const Chunk& chunk, std::vector<ColorVertex>& out, GLint column_first[]);
+    ChunkMesh* find(Point coord) const;
+    void insert(ChunkMesh* mesh);
+    void rebuild_index(size_t expected);
+
+    SlabPool<ChunkMesh, 64> meshes;
+    // Open-addressed coord -> mesh index, power-of-two sized, at most half
+    // full; rebuilt whenever meshes are released
+    std::vector<ChunkMesh*> index;
+    std::vector<ChunkMesh*> draw_order;
+    std::vector<ColorVertex> scratch;
+    unsigned sync_counter = 0;
+    size_t last_draw_calls = 0;
+    CullStats last_cull;
+};
+
+#endif // CHUNK_MESH_H
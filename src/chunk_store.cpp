@@ -0,0 +1,121 @@
+#include "chunk_store.h"
+
+ChunkStore::ReadGuard::ReadGuard(const ChunkStore& store) : store(store) {
+    // Pin the current epoch. If a reclaimer flipped the epoch between the
+    // load and the increment, our count may have been missed: retry.
+    for (;;) {
+        epoch = store.epoch.load();
+        store.readers[epoch & 1].fetch_add(1);
+        if (store.epoch.load() == epoch) break;
+        store.readers[epoch & 1].fetch_sub(1);
+    }
+}
+
+ChunkStore::ReadGuard::~ReadGuard() {
+    store.readers[epoch & 1].fetch_sub(1);
+}
+
+ChunkStore::ChunkStore() : count(0), epoch(1) {
+    for (auto& bucket : buckets) {
+        bucket.store(nullptr, std::memory_order_relaxed);
+    }
+    readers[0].store(0);
+    readers[1].store(0);
+}
+
+ChunkStore::~ChunkStore() {
+    // SlabPool destroys whatever is still live, retired nodes included
+}
+
+size_t ChunkStore::bucket_of(Point coord) {
+    // PointHash alone clusters neighbouring chunks, mix it before masking
+    uint64_t h = PointHash{}(coord);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h & (BUCKET_COUNT - 1);
+}
+
+const ChunkStore::Node* ChunkStore::find_in_chain(const Node* head, Point coord) {
+    for (const Node* n = head; n; n = n->next.load(std::memory_order_acquire)) {
+        if (n->coord == coord) return n;
+    }
+    return nullptr;
+}
+
+const Chunk* ChunkStore::find(Point coord) const {
+    const Node* head = buckets[bucket_of(coord)].load(std::memory_order_acquire);
+    const Node* n = find_in_chain(head, coord);
+    return n ? &n->chunk : nullptr;
+}
+
+const Chunk* ChunkStore::publish(Point coord, const Chunk& chunk) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    std::atomic<Node*>& bucket = buckets[bucket_of(coord)];
+    Node* head = bucket.load(std::memory_order_acquire);
+    if (const Node* existing = find_in_chain(head, coord)) {
+        return &existing->chunk;
+    }
+
+    // Fully build the node before the release store makes it reachable
+    Node* node = pool.create(coord, chunk);
+    node->next.store(head, std::memory_order_relaxed);
+    bucket.store(node, std::memory_order_release);
+    count.fetch_add(1, std::memory_order_release);
+    if (!retired.empty()) try_reclaim();
+    return &node->chunk;
+}
+
+size_t ChunkStore::evict_outside(Point min, Point max) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    size_t removed = 0;
+    uint64_t now = epoch.load();
+    for (size_t i = 0; i < pool.live_count(); ++i) {
+        Node* n = pool.live_at(i);
+        const Point& c = n->coord;
+        if (n->retired) continue;
+        if (c.first >= min.first && c.first <= max.first && c.second >= min.second && c.second <= max.second) continue;
+
+        // Unlink in place; a reader already standing on n still follows a
+        // valid next pointer because n is only recycled once it unpins
+        std::atomic<Node*>* link = &buckets[bucket_of(c)];
+        while (link->load(std::memory_order_relaxed) != n) {
+            link = &link->load(std::memory_order_relaxed)->next;
+        }
+        link->store(n->next.load(std::memory_order_relaxed), std::memory_order_release);
+        n->retired = true;
+        n->retired_epoch = now;
+        retired.push_back(n);
+        ++removed;
+    }
+    count.fetch_sub(removed, std::memory_order_release);
+    evicted += removed;
+    try_reclaim();
+    return removed;
+}
+
+void ChunkStore::try_reclaim() {
+    // Invariant: at epoch e, no reader pinned at e - 2 or earlier remains.
+    // Once the e - 1 parity drains, nothing retired before e is reachable.
+    uint64_t e = epoch.load();
+    if (readers[(e - 1) & 1].load() != 0) return;
+
+    size_t kept = 0;
+    for (Node* n : retired) {
+        if (n->retired_epoch < e) {
+            pool.destroy(n);
+        } else {
+            retired[kept++] = n;
+        }
+    }
+    retired.resize(kept);
+    epoch.store(e + 1);
+}
+
+ChunkStore::Stats ChunkStore::stats() const {
+    Stats s;
+    s.pool = pool.stats();
+    s.retired = retired.size();
+    s.evicted = evicted;
+    return s;
+}
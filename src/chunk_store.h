@@ -0,0 +1,97 @@
+#ifndef CHUNK_STORE_H
+#define CHUNK_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "chunk.h"
+#include "slab_pool.h"
+
+// Concurrent chunk coordinate -> chunk map.
+// Chunks are immutable once published, so readers (main thread, generation
+// workers, pathfinding, minimap...) never take a lock: they walk bucket
+// chains whose links are swapped atomically by writers. Writers serialise
+// on a mutex among themselves.
+//
+// Evicted chunks are reclaimed epoch-style: a reader on another thread pins
+// the current epoch with a ReadGuard for as long as it holds chunk pointers,
+// and retired chunks only go back to the slab pool once every reader that
+// could have seen them has unpinned. The writer thread itself needs no guard.
+class ChunkStore {
+public:
+    static const size_t BUCKET_COUNT = 4096; // power of two
+
+    struct Stats {
+        SlabPoolStats pool;
+        size_t retired = 0; // evicted, waiting for readers to drain
+        size_t evicted = 0;
+    };
+
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const ChunkStore& store);
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    private:
+        const ChunkStore& store;
+        uint64_t epoch;
+    };
+
+    ChunkStore();
+    ~ChunkStore();
+    ChunkStore(const ChunkStore&) = delete;
+    ChunkStore& operator=(const ChunkStore&) = delete;
+
+    // Lock-free lookup, nullptr if the chunk has not been published yet
+    const Chunk* find(Point coord) const;
+    // Publishes a chunk. If another writer got there first, their chunk is
+    // kept and returned instead, so every reader sees a single version.
+    const Chunk* publish(Point coord, const Chunk& chunk);
+    // Unlinks every chunk outside [min, max] (inclusive chunk coordinates)
+    // and recycles whatever is no longer visible to any reader
+    size_t evict_outside(Point min, Point max);
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    Stats stats() const;
+
+    // Writer-side iteration over live chunks, packed in slab order.
+    // Not for concurrent readers: eviction reorders the pool's live array.
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < pool.live_count(); ++i) {
+            const Node* n = pool.live_at(i);
+            if (!n->retired) fn(n->coord, n->chunk);
+        }
+    }
+
+private:
+    struct Node {
+        Point coord;
+        Chunk chunk;
+        std::atomic<Node*> next{nullptr}; // bucket chain
+        uint64_t retired_epoch = 0;
+        bool retired = false;
+
+        Node(Point coord, const Chunk& chunk) : coord(coord), chunk(chunk) {}
+    };
+
+    static size_t bucket_of(Point coord);
+    static const Node* find_in_chain(const Node* head, Point coord);
+    void try_reclaim();
+
+    std::atomic<Node*> buckets[BUCKET_COUNT];
+    std::atomic<size_t> count;
+
+    std::mutex write_mutex;
+    SlabPool<Node, 32> pool;
+    std::vector<Node*> retired;
+    size_t evicted = 0;
+
+    // Epoch parity counters of pinned readers, see ReadGuard
+    std::atomic<uint64_t> epoch;
+    mutable std::atomic<int> readers[2];
+};
+
+#endif // CHUNK_STORE_H
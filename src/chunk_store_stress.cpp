@@ -0,0 +1,148 @@
+// Stress test and read benchmark for ChunkStore's lock-free readers.
+//
+//   chunk_store_stress [--seconds S] [--threads N]
+//
+// A writer slides a window of chunks across the map, publishing the column
+// ahead of it and evicting the one behind, so retired nodes go back to the
+// slab pool and get reused all the time. Readers pin an epoch with a
+// ReadGuard and look up chunks around the window, including ones being
+// evicted. Every chunk is stamped with its coordinate: a chunk whose stamp
+// doesn't match the key it was found under is a recycled node a reader
+// could still see, and the tool exits non-zero.
+//
+// Runs once for each reader count from 1 to N (default: one per core) and
+// prints reads per second as CSV.
+
+#include "chunk_store.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static const int WINDOW = 16;      // chunks per side of the published window
+static const int READ_MARGIN = 4;  // readers also look this far outside it
+static const int READS_PER_GUARD = 32;
+
+static int stamp_of(Point coord) {
+    return coord.first * 7919 + coord.second * 104729;
+}
+
+static Chunk stamped_chunk(Point coord) {
+    Chunk chunk;
+    // Any int is a valid Tiles value; these never reach the renderer
+    chunk.tiles[0][0] = (Tiles)coord.first;
+    chunk.tiles[0][1] = (Tiles)coord.second;
+    chunk.tiles[Chunk::SIZE / 2][Chunk::SIZE / 2] = (Tiles)stamp_of(coord);
+    chunk.tiles[Chunk::SIZE - 1][Chunk::SIZE - 1] = (Tiles)stamp_of(coord);
+    return chunk;
+}
+
+static bool stamp_matches(const Chunk& chunk, Point coord) {
+    return chunk.tiles[0][0] == (Tiles)coord.first && chunk.tiles[0][1] == (Tiles)coord.second &&
+           chunk.tiles[Chunk::SIZE / 2][Chunk::SIZE / 2] == (Tiles)stamp_of(coord) &&
+           chunk.tiles[Chunk::SIZE - 1][Chunk::SIZE - 1] == (Tiles)stamp_of(coord);
+}
+
+struct RunResult {
+    long long reads = 0;
+    long long found = 0;
+    long long bad = 0;
+    long long window_steps = 0;
+    ChunkStore::Stats stats;
+};
+
+static RunResult run(int reader_count, double seconds) {
+    ChunkStore store;
+    std::atomic<int> window_x{0};
+    std::atomic<bool> stop{false};
+    std::atomic<long long> reads{0}, found{0}, bad{0};
+
+    for (int x = 0; x < WINDOW; ++x) {
+        for (int y = 0; y < WINDOW; ++y) store.publish({x, y}, stamped_chunk({x, y}));
+    }
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < reader_count; ++t) {
+        readers.emplace_back([&, t] {
+            uint32_t rng = 0x9E3779B9u * (t + 1);
+            long long my_reads = 0, my_found = 0, my_bad = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                ChunkStore::ReadGuard guard(store);
+                int base = window_x.load(std::memory_order_relaxed);
+                for (int i = 0; i < READS_PER_GUARD; ++i) {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 17;
+                    rng ^= rng << 5;
+                    int span = WINDOW + 2 * READ_MARGIN;
+                    Point coord{base - READ_MARGIN + (int)(rng % span), (int)((rng >> 16) % WINDOW)};
+                    const Chunk* chunk = store.find(coord);
+                    ++my_reads;
+                    if (!chunk) continue;
+                    ++my_found;
+                    if (!stamp_matches(*chunk, coord)) ++my_bad;
+                }
+            }
+            reads += my_reads;
+            found += my_found;
+            bad += my_bad;
+        });
+    }
+
+    // Writer: step the window one column at a time until time is up
+    long long steps = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        int x = window_x.load(std::memory_order_relaxed) + 1;
+        for (int y = 0; y < WINDOW; ++y) store.publish({x + WINDOW - 1, y}, stamped_chunk({x + WINDOW - 1, y}));
+        window_x.store(x, std::memory_order_relaxed);
+        store.evict_outside({x, 0}, {x + WINDOW - 1, WINDOW - 1});
+        ++steps;
+    }
+    stop = true;
+    for (std::thread& t : readers) t.join();
+
+    RunResult result;
+    result.reads = reads;
+    result.found = found;
+    result.bad = bad;
+    result.window_steps = steps;
+    result.stats = store.stats();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    double seconds = 1.0;
+    int max_threads = (int)std::thread::hardware_concurrency();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            max_threads = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--seconds S] [--threads N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (max_threads < 1) max_threads = 1;
+
+    int failures = 0;
+    std::printf("readers,reads_per_sec,found_pct,window_steps,recycled,bad\n");
+    for (int readers = 1; readers <= max_threads; ++readers) {
+        RunResult r = run(readers, seconds);
+        std::printf("%d,%.0f,%.1f,%lld,%zu,%lld\n", readers, r.reads / seconds,
+                    r.reads ? 100.0 * r.found / r.reads : 0.0, r.window_steps, r.stats.pool.recycled, r.bad);
+        if (r.bad) {
+            std::fprintf(stderr, "%d readers: %lld reads saw a recycled chunk\n", readers, r.bad);
+            failures++;
+        }
+        if (r.stats.pool.recycled == 0) {
+            std::fprintf(stderr, "%d readers: no node was recycled, nothing was tested\n", readers);
+            failures++;
+        }
+    }
+    return failures ? 1 : 0;
+}
@@ -1,90 +1,374 @@
 #include "geometry.h"
+#include "stream_buffer.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
 
-void set_transform(GLuint program, float tx, float ty, float scaleX, float scaleY, float rotation) {
+// --- Location cache ---------------------------------------------------------
+
+struct CachedLocation {
+    GLuint program;
+    bool uniform;
+    std::string name;
+    GLint location;
+};
+
+static std::vector<CachedLocation> g_locations;
+static RenderStats g_pending_stats;
+static RenderStats g_last_stats;
+
+static GLint cached_location(GLuint program, const char* name, bool uniform) {
+    for (const CachedLocation& loc : g_locations) {
+        if (loc.program == program && loc.uniform == uniform && loc.name == name) return loc.location;
+    }
+    GLint location = uniform ? glGetUniformLocation(program, name) : glGetAttribLocation(program, name);
+    g_locations.push_back({program, uniform, name, location});
+    g_pending_stats.location_lookups++;
+    return location;
+}
+
+GLint uniform_location(GLuint program, const char* name) {
+    return cached_location(program, name, true);
+}
+
+GLint attrib_location(GLuint program, const char* name) {
+    return cached_location(program, name, false);
+}
+
+// --- State tracking ---------------------------------------------------------
+
+// What we last told GL. Reset at the start of every flush because ImGui and
+// anything else drawing between flushes changes state behind our back.
+struct TrackedState {
+    GLuint program = 0;
+    GLuint vbo = 0;
+    VertexLayout layout = VertexLayout::POSITION;
+    bool blend = false;
+    float line_width = 0.0f;
+    float color[4] = {};
+    float transform[9] = {};
+    bool camera_space = false;
+    GLuint texture = 0;
+    GLint enabled_attribs[3] = {-1, -1, -1}; // position, color, shape
+    bool known = false;     // program/vbo/blend/line width valid
+    bool pointers = false;  // attribute pointers match vbo + layout
+    bool uniforms = false;  // color/transform/view match the bound program
+};
+
+static TrackedState g_gl;
+
+static const float IDENTITY[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+// Re-anchor only when the camera strays this far (tiles), so model
+// transforms of world geometry rarely change
+static const int CAMERA_ANCHOR_GRID = 1024;
+static CameraAnchor g_camera_anchor;
+static float g_camera_view[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+void set_camera_view(float camX, float camY, float aspect, float zoom) {
+    g_camera_anchor.x = (int)floor(camX / CAMERA_ANCHOR_GRID) * CAMERA_ANCHOR_GRID;
+    g_camera_anchor.y = (int)floor(camY / CAMERA_ANCHOR_GRID) * CAMERA_ANCHOR_GRID;
+    // Offset of the camera from the anchor is small, so this stays precise
+    float offsetX = camX - (float)g_camera_anchor.x;
+    float offsetY = camY - (float)g_camera_anchor.y;
+    make_transform(g_camera_view, -offsetX * zoom / aspect, -offsetY * zoom, zoom / aspect, zoom);
+}
+
+const CameraAnchor& get_camera_anchor() {
+    return g_camera_anchor;
+}
+
+static bool track(bool changed) {
+    if (changed) g_pending_stats.state_changes++;
+    else g_pending_stats.redundant_skipped++;
+    return changed;
+}
+
+static void use_program(GLuint program) {
+    if (track(!g_gl.known || g_gl.program != program)) {
+        glUseProgram(program);
+        g_gl.program = program;
+        g_gl.pointers = false;
+        g_gl.uniforms = false;
+    }
+}
+
+static void bind_buffer(GLuint vbo) {
+    if (track(!g_gl.known || g_gl.vbo != vbo)) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        g_gl.vbo = vbo;
+        g_gl.pointers = false;
+    }
+}
+
+static void set_blend(bool blend) {
+    if (track(!g_gl.known || g_gl.blend != blend)) {
+        if (blend) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        } else {
+            glDisable(GL_BLEND);
+        }
+        g_gl.blend = blend;
+    }
+}
+
+static void bind_texture(GLuint texture) {
+    if (texture == 0) return;
+    if (track(!g_gl.known || g_gl.texture != texture)) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        g_gl.texture = texture;
+    }
+}
+
+static void set_line_width(float width) {
+    if (width <= 0.0f) return;
+    if (track(!g_gl.known || g_gl.line_width != width)) {
+        glLineWidth(width);
+        g_gl.line_width = width;
+    }
+}
+
+static void set_attrib_array(int slot, GLint location) {
+    GLint& enabled = g_gl.enabled_attribs[slot];
+    if (!track(enabled != location)) return;
+    if (enabled >= 0) glDisableVertexAttribArray(enabled);
+    if (location >= 0) glEnableVertexAttribArray(location);
+    enabled = location;
+}
+
+static void set_pointers(GLuint program, VertexLayout layout) {
+    if (!track(!g_gl.pointers || g_gl.layout != layout)) return;
+    GLint posAttrib = attrib_location(program, "position");
+    if (layout == VertexLayout::SHAPE) {
+        GLint colorAttrib = attrib_location(program, "color");
+        GLint shapeAttrib = attrib_location(program, "shape");
+        set_attrib_array(0, posAttrib);
+        set_attrib_array(1, colorAttrib);
+        set_attrib_array(2, shapeAttrib);
+        glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (void*)0);
+        glVertexAttribPointer(colorAttrib, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ShapeVertex), (void*)(2 * sizeof(float)));
+        glVertexAttribPointer(shapeAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (void*)(2 * sizeof(float) + 4));
+    } else if (layout == VertexLayout::POSITION_COLOR) {
+        GLint colorAttrib = attrib_location(program, "color");
+        set_attrib_array(0, posAttrib);
+        set_attrib_array(1, colorAttrib);
+        set_attrib_array(2, -1);
+        glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(ColorVertex), (void*)0);
+        glVertexAttribPointer(colorAttrib, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ColorVertex), (void*)(2 * sizeof(float)));
+    } else {
+        set_attrib_array(0, posAttrib);
+        set_attrib_array(1, -1);
+        set_attrib_array(2, -1);
+        glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    }
+    g_gl.layout = layout;
+    g_gl.pointers = true;
+}
+
+static void set_uniforms(const DrawCommand& cmd) {
+    if (cmd.layout == VertexLayout::POSITION &&
+        track(!g_gl.uniforms || std::memcmp(g_gl.color, cmd.color, sizeof(cmd.color)) != 0)) {
+        glUniform4fv(uniform_location(cmd.program, "color"), 1, cmd.color);
+        std::memcpy(g_gl.color, cmd.color, sizeof(cmd.color));
+    }
+    if (track(!g_gl.uniforms || std::memcmp(g_gl.transform, cmd.transform, sizeof(cmd.transform)) != 0)) {
+        glUniformMatrix3fv(uniform_location(cmd.program, "transform"), 1, GL_FALSE, cmd.transform);
+        std::memcpy(g_gl.transform, cmd.transform, sizeof(cmd.transform));
+    }
+    if (track(!g_gl.uniforms || g_gl.camera_space != cmd.camera_space)) {
+        glUniformMatrix3fv(uniform_location(cmd.program, "view"), 1, GL_FALSE,
+                           cmd.camera_space ? g_camera_view : IDENTITY);
+        g_gl.camera_space = cmd.camera_space;
+    }
+    g_gl.uniforms = true;
+}
+
+// --- Command buffer ---------------------------------------------------------
+
+static std::vector<DrawCommand> g_commands;
+static int g_layer = 0;
+static StreamBuffer g_stream;
+
+void set_draw_layer(int layer) {
+    g_layer = layer;
+}
+
+void submit_draw(DrawCommand cmd) {
+    cmd.layer = g_layer;
+    g_commands.push_back(cmd);
+}
+
+// Ranges of one buffer drawn back to back with identical state become one
+// draw. Only for list modes; strips and fans can't be concatenated.
+static bool can_merge(const DrawCommand& a, const DrawCommand& b) {
+    if (a.mode != GL_TRIANGLES && a.mode != GL_LINES && a.mode != GL_POINTS) return false;
+    return a.layer == b.layer && a.program == b.program && a.vbo == b.vbo &&
+           a.layout == b.layout && a.blend == b.blend && a.mode == b.mode &&
+           a.first + a.count == b.first && a.line_width == b.line_width &&
+           a.camera_space == b.camera_space && a.texture == b.texture &&
+           !a.custom_uniforms && !b.custom_uniforms &&
+           std::memcmp(a.color, b.color, sizeof(a.color)) == 0 &&
+           std::memcmp(a.transform, b.transform, sizeof(a.transform)) == 0;
+}
+
+void flush_draw_commands() {
+    g_pending_stats.stream_bytes = g_stream.upload();
+    std::stable_sort(g_commands.begin(), g_commands.end(), [](const DrawCommand& a, const DrawCommand& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.program != b.program) return a.program < b.program;
+        if (a.vbo != b.vbo) return a.vbo < b.vbo;
+        return a.blend < b.blend;
+    });
+
+    g_gl = TrackedState{};
+    for (size_t i = 0; i < g_commands.size(); ++i) {
+        DrawCommand cmd = g_commands[i];
+        while (i + 1 < g_commands.size() && can_merge(cmd, g_commands[i + 1])) {
+            cmd.count += g_commands[++i].count;
+            g_pending_stats.merged_draws++;
+        }
+        use_program(cmd.program);
+        bind_buffer(cmd.vbo);
+        set_blend(cmd.blend);
+        g_gl.known = true;
+        set_pointers(cmd.program, cmd.layout);
+        set_uniforms(cmd);
+        bind_texture(cmd.texture);
+        if (cmd.custom_uniforms) cmd.custom_uniforms(cmd.program, cmd.user);
+        if (cmd.mode == GL_LINES) set_line_width(cmd.line_width);
+        glDrawArrays(cmd.mode, cmd.first, cmd.count);
+        g_pending_stats.draw_calls++;
+    }
+    // Leave no arrays enabled for whoever draws next
+    set_attrib_array(0, -1);
+    set_attrib_array(1, -1);
+    set_attrib_array(2, -1);
+    g_stream.next_frame();
+
+    g_pending_stats.commands = (int)g_commands.size();
+    g_last_stats = g_pending_stats;
+    g_pending_stats = RenderStats{};
+    g_commands.clear();
+    g_layer = 0;
+}
+
+const RenderStats& get_render_stats() {
+    return g_last_stats;
+}
+
+// --- Primitives -------------------------------------------------------------
+
+void make_transform(float out[9], float tx, float ty, float scaleX, float scaleY, float rotation) {
     float c = cos(rotation);
     float s = sin(rotation);
-    
+
     float matrix[9] = {
         scaleX * c,  scaleX * s, 0.0f,
         -scaleY * s, scaleY * c, 0.0f,
         tx,          ty,         1.0f
     };
-    
-    GLint transformLoc = glGetUniformLocation(program, "transform");
-    glUniformMatrix3fv(transformLoc, 1, GL_FALSE, matrix);
-}
-
-void draw_disc(GLuint vbo, float x, float y, float radius, float r, float g, float b, GLuint program, float aspect) {
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    GLint posAttrib = glGetAttribLocation(program, "position");
-    glEnableVertexAttribArray(posAttrib);
-    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    
-    GLint colorUniform = glGetUniformLocation(program, "color");
-    glUniform4f(colorUniform, r, g, b, 1.0f);
-    
-    set_transform(program, x, y, radius / aspect, radius);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 32);
-}
-
-void draw_triangle(GLuint vbo, float x, float y, float scale, float angle, float r, float g, float b, GLuint program, float aspect) {
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    GLint posAttrib = glGetAttribLocation(program, "position");
-    glEnableVertexAttribArray(posAttrib);
-    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    
-    GLint colorUniform = glGetUniformLocation(program, "color");
-    glUniform4f(colorUniform, r, g, b, 1.0f);
-    
-    set_transform(program, x, y, scale / aspect, scale, angle);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-}
-
-void draw_line(GLuint vbo, float x1, float y1, float x2, float y2, float r, float g, float b, GLuint program, float aspect) {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    float len = sqrt(dx * dx + dy * dy);
-    float angle = atan2(dy, dx);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    GLint posAttrib = glGetAttribLocation(program, "position");
-    glEnableVertexAttribArray(posAttrib);
-    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-    GLint colorUniform = glGetUniformLocation(program, "color");
-    glUniform4f(colorUniform, r, g, b, 1.0f);
+    std::memcpy(out, matrix, sizeof(matrix));
+}
 
-    set_transform(program, x1, y1, len, 1.0f, angle);
-    glLineWidth(2.0f);
-    glDrawArrays(GL_LINES, 0, 2);
+void set_transform(GLuint program, float tx, float ty, float scaleX, float scaleY, float rotation) {
+    float matrix[9];
+    make_transform(matrix, tx, ty, scaleX, scaleY, rotation);
+    glUniformMatrix3fv(uniform_location(program, "transform"), 1, GL_FALSE, matrix);
 }
 
-void draw_square(GLuint vbo,
-                 float x, float y,
-                 float size,
-                 float r, float g, float b, float alpha,
-                 GLuint program,
-                 float aspect)
-{
-    glUseProgram(program);
+DrawCommand stream_draw(GLuint program, GLenum mode, const ColorVertex* vertices, int count) {
+    DrawCommand cmd;
+    cmd.program = program;
+    cmd.vbo = g_stream.buffer();
+    cmd.layout = VertexLayout::POSITION_COLOR;
+    cmd.mode = mode;
+    cmd.first = g_stream.append(vertices, count);
+    cmd.count = count;
+    return cmd;
+}
 
-    // Enable alpha blending (REQUIRED for transparency)
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+static void to_rgba(GLubyte out[4], float r, float g, float b, float a) {
+    out[0] = (GLubyte)lround(std::min(std::max(r, 0.0f), 1.0f) * 255.0f);
+    out[1] = (GLubyte)lround(std::min(std::max(g, 0.0f), 1.0f) * 255.0f);
+    out[2] = (GLubyte)lround(std::min(std::max(b, 0.0f), 1.0f) * 255.0f);
+    out[3] = (GLubyte)lround(std::min(std::max(a, 0.0f), 1.0f) * 255.0f);
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+void PrimitiveBatch::push(float x, float y, const GLubyte rgba[4], float u, float v, float feather) {
+    vertices.push_back({x, y, rgba[0], rgba[1], rgba[2], rgba[3], u, v, feather});
+}
 
-    GLint posAttrib = glGetAttribLocation(program, "position");
-    glEnableVertexAttribArray(posAttrib);
-    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void PrimitiveBatch::disc(float x, float y, float radius, float r, float g, float b, float aspect, float a) {
+    GLubyte rgba[4];
+    to_rgba(rgba, r, g, b, a);
+    // About one pixel of edge, whatever the disc's size on screen
+    float feather = std::min(1.0f, 1.0f / std::max(radius * pixels_per_unit, 1e-3f));
+    float rx = radius / aspect;
+    push(x - rx, y - radius, rgba, -1.0f, -1.0f, feather);
+    push(x + rx, y - radius, rgba, 1.0f, -1.0f, feather);
+    push(x + rx, y + radius, rgba, 1.0f, 1.0f, feather);
+    push(x - rx, y - radius, rgba, -1.0f, -1.0f, feather);
+    push(x + rx, y + radius, rgba, 1.0f, 1.0f, feather);
+    push(x - rx, y + radius, rgba, -1.0f, 1.0f, feather);
+}
 
-    GLint colorUniform = glGetUniformLocation(program, "color");
-    glUniform4f(colorUniform, r, g, b, alpha); // e.g. (1, 0, 0, 0.5)
+void PrimitiveBatch::triangle(float x, float y, float scale, float angle, float r, float g, float b, float aspect, float a) {
+    // Same outline as triangleVbo
+    static const float verts[3][2] = {{1.0f, 0.0f}, {-0.6f, 0.6f}, {-0.6f, -0.6f}};
+    GLubyte rgba[4];
+    to_rgba(rgba, r, g, b, a);
+    float m[9];
+    make_transform(m, x, y, scale / aspect, scale, angle);
+    for (const auto& v : verts) {
+        push(m[0] * v[0] + m[3] * v[1] + m[6], m[1] * v[0] + m[4] * v[1] + m[7], rgba);
+    }
+}
 
-    set_transform(program, x, y, size / aspect, size);
+void PrimitiveBatch::line(float x1, float y1, float x2, float y2, float width, float r, float g, float b, float aspect, float a) {
+    // Offset perpendicular to the line in unstretched space, so the width
+    // is the same whatever the direction
+    float dx = (x2 - x1) * aspect;
+    float dy = y2 - y1;
+    float len = sqrt(dx * dx + dy * dy);
+    if (len <= 0.0f) return;
+    float nx = -dy / len * width * 0.5f / aspect;
+    float ny = dx / len * width * 0.5f;
+    GLubyte rgba[4];
+    to_rgba(rgba, r, g, b, a);
+    push(x1 + nx, y1 + ny, rgba);
+    push(x1 - nx, y1 - ny, rgba);
+    push(x2 - nx, y2 - ny, rgba);
+    push(x1 + nx, y1 + ny, rgba);
+    push(x2 - nx, y2 - ny, rgba);
+    push(x2 + nx, y2 + ny, rgba);
+}
 
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+void PrimitiveBatch::square(float x, float y, float size, float r, float g, float b, float a, float aspect) {
+    GLubyte rgba[4];
+    to_rgba(rgba, r, g, b, a);
+    float sx = size / aspect;
+    push(x, y, rgba);
+    push(x + sx, y, rgba);
+    push(x + sx, y + size, rgba);
+    push(x, y, rgba);
+    push(x + sx, y + size, rgba);
+    push(x, y + size, rgba);
+}
 
-    glDisableVertexAttribArray(posAttrib);
-}
\ No newline at end of file
+void PrimitiveBatch::submit(GLuint program, bool camera_space) {
+    if (vertices.empty()) return;
+    DrawCommand cmd;
+    cmd.program = program;
+    cmd.vbo = g_stream.buffer();
+    cmd.layout = VertexLayout::SHAPE;
+    cmd.blend = true;
+    cmd.mode = GL_TRIANGLES;
+    cmd.first = g_stream.append(vertices.data(), (int)vertices.size());
+    cmd.count = (GLsizei)vertices.size();
+    cmd.camera_space = camera_space;
+    submit_draw(cmd);
+    vertices.clear();
+}
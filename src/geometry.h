@@ -1,12 +1,126 @@
 #ifndef GEOMETRY_H
 #define GEOMETRY_H
 
-#include <SDL_opengles2.h>
+#include "gl.h"
+#include <cstddef>
+#include <vector>
 
-void draw_disc(GLuint vbo, float x, float y, float radius, float r, float g, float b, GLuint program, float aspect);
-void draw_triangle(GLuint vbo, float x, float y, float scale, float angle, float r, float g, float b, GLuint program, float aspect);
-void draw_line(GLuint vbo, float x1, float y1, float x2, float y2, float r, float g, float b, GLuint program, float aspect);
-void draw_square(GLuint vbo, float x, float y, float size, float r, float g, float b, float alpha, GLuint program, float aspect);
+// Draws are recorded, not issued: call flush_draw_commands() once per
+// frame. Commands are sorted by (layer, program, buffer, blend) so state
+// only changes between groups; submission order is kept inside a group,
+// and layers keep back-to-front order across groups.
 void set_transform(GLuint program, float tx, float ty, float scaleX, float scaleY, float rotation = 0.0f);
+void make_transform(float out[9], float tx, float ty, float scaleX, float scaleY, float rotation = 0.0f);
+
+// Interleaved vertex of a baked mesh: position + normalised RGBA
+struct ColorVertex {
+    float x, y;
+    GLubyte r, g, b, a;
+};
+
+// Vertex of a batched shape. `shape` is the position inside a disc quad
+// (u, v in -1..1, edge at length 1) and the antialiasing band width in the
+// same units; solid shapes use (0, 0, 1).
+struct ShapeVertex {
+    float x, y;
+    GLubyte r, g, b, a;
+    float u, v, feather;
+};
+
+enum class VertexLayout {
+    POSITION,       // vec2 position, colour from the `color` uniform
+    POSITION_COLOR, // ColorVertex: vec2 position + normalised RGBA `color` attribute
+    SHAPE           // ShapeVertex: POSITION_COLOR plus a vec3 `shape` attribute
+};
+
+struct DrawCommand {
+    int layer = 0;
+    GLuint program = 0;
+    GLuint vbo = 0;
+    VertexLayout layout = VertexLayout::POSITION;
+    bool blend = false;
+    GLenum mode = GL_TRIANGLES;
+    GLint first = 0;
+    GLsizei count = 0;
+    float line_width = 0.0f; // 0 = don't care
+    bool camera_space = false; // apply the camera view, else vertices are in clip space
+    GLuint texture = 0;        // bound to unit 0 when non-zero
+    // Extra per-draw uniforms, called with the program bound
+    void (*custom_uniforms)(GLuint program, const void* user) = nullptr;
+    const void* user = nullptr;
+    float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    float transform[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+};
+
+// World-space commands are positioned relative to an integer anchor near the
+// camera, so float vertex positions stay small (and exact for tiles) at any
+// player coordinate. Only the view uniform changes when the camera moves.
+// The anchor is in world units and always integral.
+struct CameraAnchor {
+    int x = 0;
+    int y = 0;
+};
+
+// Sets this frame's view for camera_space commands
+void set_camera_view(float camX, float camY, float aspect, float zoom);
+const CameraAnchor& get_camera_anchor();
+
+// Layer stamped on subsequently recorded commands
+void set_draw_layer(int layer);
+void submit_draw(DrawCommand cmd);
+void flush_draw_commands();
+
+// Per-frame geometry: vertices are copied into the stream buffer (uploaded
+// once at flush) and a POSITION_COLOR command over them is returned, ready
+// to adjust and submit. Consecutive stream commands with the same state are
+// merged into one draw, so positions should be pre-transformed.
+DrawCommand stream_draw(GLuint program, GLenum mode, const ColorVertex* vertices, int count);
+
+// Batched shapes. Shapes are transformed on the CPU into ShapeVertex
+// triangles with their own colour, so a whole batch is a single streamed
+// draw whatever it contains. Discs are quads cut out by a distance test in
+// the fragment shader, and lines are quads of a given width. x is divided
+// by aspect, so pass aspect 1 for camera-space batches.
+class PrimitiveBatch {
+public:
+    // Screen pixels per batch unit vertically, for disc antialiasing:
+    // half the screen height in clip space, times zoom in camera space
+    explicit PrimitiveBatch(float pixels_per_unit) : pixels_per_unit(pixels_per_unit) {}
+
+    void disc(float x, float y, float radius, float r, float g, float b, float aspect, float a = 1.0f);
+    // Unit ship triangle pointing along angle, like triangleVbo
+    void triangle(float x, float y, float scale, float angle, float r, float g, float b, float aspect, float a = 1.0f);
+    void line(float x1, float y1, float x2, float y2, float width, float r, float g, float b, float aspect, float a = 1.0f);
+    void square(float x, float y, float size, float r, float g, float b, float a, float aspect);
+
+    // Records everything added as one blended GL_TRIANGLES command and
+    // empties the batch; program needs `position`, `color`, `shape`
+    void submit(GLuint program, bool camera_space = false);
+
+    size_t vertex_count() const { return vertices.size(); }
+
+private:
+    void push(float x, float y, const GLubyte rgba[4], float u = 0.0f, float v = 0.0f, float feather = 1.0f);
+
+    float pixels_per_unit;
+    std::vector<ShapeVertex> vertices;
+};
+
+// Cached shader locations, looked up once per program
+GLint uniform_location(GLuint program, const char* name);
+GLint attrib_location(GLuint program, const char* name);
+
+struct RenderStats {
+    int commands = 0;
+    int draw_calls = 0;
+    int state_changes = 0;   // program/buffer/blend/attrib/line width/uniform changes issued
+    int redundant_skipped = 0; // the same changes avoided by the tracker
+    int location_lookups = 0;  // cache misses in uniform_location/attrib_location
+    int merged_draws = 0;      // commands folded into the previous draw
+    size_t stream_bytes = 0;   // vertex data uploaded through the stream buffer
+};
+
+// Counters of the most recent flush
+const RenderStats& get_render_stats();
 
 #endif
@@ -0,0 +1,13 @@
+#ifndef SPACEGAME_GL_H
+#define SPACEGAME_GL_H
+
+// The GLES2 API as the renderer sees it. Builds with SPACEGAME_GL_RECORD
+// (the render bench) get a recording stand-in that counts calls instead of
+// talking to a GPU; everything else gets the real thing.
+#ifdef SPACEGAME_GL_RECORD
+#include "gl_record.h"
+#else
+#include <SDL_opengles2.h>
+#endif
+
+#endif // SPACEGAME_GL_H
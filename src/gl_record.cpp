@@ -0,0 +1,119 @@
+#include "gl_record.h"
+#include <cstring>
+
+static GLRecordStats g_frame;
+static GLuint g_next_name = 1;
+static GLint g_next_location = 0;
+
+static void state_change() {
+    g_frame.calls++;
+    g_frame.state_changes++;
+}
+
+static void uniform_upload() {
+    g_frame.calls++;
+    g_frame.uniform_uploads++;
+}
+
+static void gen_names(GLsizei n, GLuint* names) {
+    g_frame.calls++;
+    for (GLsizei i = 0; i < n; ++i) names[i] = g_next_name++;
+}
+
+static size_t texel_bytes(GLenum format) {
+    switch (format) {
+        case GL_RGBA: return 4;
+        case GL_RGB: return 3;
+        default: return 1; // LUMINANCE, ALPHA
+    }
+}
+
+GLRecordStats gl_record_take_frame() {
+    GLRecordStats frame = g_frame;
+    g_frame = GLRecordStats{};
+    return frame;
+}
+
+GLuint glCreateShader(GLenum) { g_frame.calls++; return g_next_name++; }
+void glShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) { g_frame.calls++; }
+void glCompileShader(GLuint) { g_frame.calls++; }
+GLuint glCreateProgram() { g_frame.calls++; return g_next_name++; }
+void glAttachShader(GLuint, GLuint) { g_frame.calls++; }
+void glLinkProgram(GLuint) { g_frame.calls++; }
+void glUseProgram(GLuint) { state_change(); }
+
+GLint glGetUniformLocation(GLuint, const GLchar*) {
+    g_frame.calls++;
+    g_frame.location_queries++;
+    return g_next_location++;
+}
+
+GLint glGetAttribLocation(GLuint, const GLchar* name) {
+    g_frame.calls++;
+    g_frame.location_queries++;
+    // Fixed slots, so a program's attributes never alias
+    if (std::strcmp(name, "position") == 0) return 0;
+    if (std::strcmp(name, "color") == 0) return 1;
+    if (std::strcmp(name, "shape") == 0) return 2;
+    return -1;
+}
+
+void glUniform1i(GLint, GLint) { uniform_upload(); }
+void glUniform1f(GLint, GLfloat) { uniform_upload(); }
+void glUniform2fv(GLint, GLsizei, const GLfloat*) { uniform_upload(); }
+void glUniform4fv(GLint, GLsizei, const GLfloat*) { uniform_upload(); }
+void glUniformMatrix3fv(GLint, GLsizei, GLboolean, const GLfloat*) { uniform_upload(); }
+
+void glGenBuffers(GLsizei n, GLuint* buffers) { gen_names(n, buffers); }
+void glDeleteBuffers(GLsizei, const GLuint*) { g_frame.calls++; }
+void glBindBuffer(GLenum, GLuint) { state_change(); }
+
+void glBufferData(GLenum, GLsizeiptr size, const void* data, GLenum) {
+    g_frame.calls++;
+    g_frame.buffer_uploads++;
+    // An orphaning call (no data) allocates but copies nothing
+    if (data) g_frame.buffer_bytes += (size_t)size;
+}
+
+void glBufferSubData(GLenum, GLintptr, GLsizeiptr size, const void*) {
+    g_frame.calls++;
+    g_frame.buffer_uploads++;
+    g_frame.buffer_bytes += (size_t)size;
+}
+
+void glEnableVertexAttribArray(GLuint) { state_change(); }
+void glDisableVertexAttribArray(GLuint) { state_change(); }
+void glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) { state_change(); }
+
+void glGenTextures(GLsizei n, GLuint* textures) { gen_names(n, textures); }
+void glDeleteTextures(GLsizei, const GLuint*) { g_frame.calls++; }
+void glActiveTexture(GLenum) { state_change(); }
+void glBindTexture(GLenum, GLuint) { state_change(); }
+void glTexParameteri(GLenum, GLenum, GLint) { state_change(); }
+void glPixelStorei(GLenum, GLint) { state_change(); }
+
+void glTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum, const void*) {
+    g_frame.calls++;
+    g_frame.texture_uploads++;
+    g_frame.texture_bytes += (size_t)width * height * texel_bytes(format);
+}
+
+void glTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum, const void*) {
+    g_frame.calls++;
+    g_frame.texture_uploads++;
+    g_frame.texture_bytes += (size_t)width * height * texel_bytes(format);
+}
+
+void glEnable(GLenum) { state_change(); }
+void glDisable(GLenum) { state_change(); }
+void glBlendFunc(GLenum, GLenum) { state_change(); }
+void glLineWidth(GLfloat) { state_change(); }
+void glViewport(GLint, GLint, GLsizei, GLsizei) { state_change(); }
+void glClearColor(GLclampf, GLclampf, GLclampf, GLclampf) { state_change(); }
+void glClear(GLbitfield) { g_frame.calls++; }
+
+void glDrawArrays(GLenum, GLint, GLsizei count) {
+    g_frame.calls++;
+    g_frame.draw_calls++;
+    g_frame.vertices += count;
+}
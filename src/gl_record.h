@@ -0,0 +1,127 @@
+#ifndef GL_RECORD_H
+#define GL_RECORD_H
+
+// Headless stand-in for the subset of GLES2 the game uses. Calls only
+// update counters (and hand out object names), so render paths can be
+// measured on machines without a GPU. Include through gl.h.
+
+#include <cstddef>
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+typedef float GLclampf;
+typedef unsigned char GLubyte;
+typedef char GLchar;
+typedef ptrdiff_t GLsizeiptr;
+typedef ptrdiff_t GLintptr;
+typedef void GLvoid;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+#define GL_POINTS 0x0000
+#define GL_LINES 0x0001
+#define GL_LINE_STRIP 0x0003
+#define GL_TRIANGLES 0x0004
+#define GL_TRIANGLE_STRIP 0x0005
+#define GL_TRIANGLE_FAN 0x0006
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_BLEND 0x0BE2
+#define GL_SCISSOR_TEST 0x0C11
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_FLOAT 0x1406
+#define GL_ALPHA 0x1906
+#define GL_RGB 0x1907
+#define GL_RGBA 0x1908
+#define GL_LUMINANCE 0x1909
+#define GL_NEAREST 0x2600
+#define GL_LINEAR 0x2601
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE_WRAP_S 0x2802
+#define GL_TEXTURE_WRAP_T 0x2803
+#define GL_REPEAT 0x2901
+#define GL_COLOR_BUFFER_BIT 0x4000
+#define GL_TEXTURE0 0x84C0
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_STREAM_DRAW 0x88E0
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+
+// Shaders and programs
+GLuint glCreateShader(GLenum type);
+void glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+void glCompileShader(GLuint shader);
+GLuint glCreateProgram();
+void glAttachShader(GLuint program, GLuint shader);
+void glLinkProgram(GLuint program);
+void glUseProgram(GLuint program);
+GLint glGetUniformLocation(GLuint program, const GLchar* name);
+GLint glGetAttribLocation(GLuint program, const GLchar* name);
+
+// Uniforms
+void glUniform1i(GLint location, GLint v0);
+void glUniform1f(GLint location, GLfloat v0);
+void glUniform2fv(GLint location, GLsizei count, const GLfloat* value);
+void glUniform4fv(GLint location, GLsizei count, const GLfloat* value);
+void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+// Buffers and vertex input
+void glGenBuffers(GLsizei n, GLuint* buffers);
+void glDeleteBuffers(GLsizei n, const GLuint* buffers);
+void glBindBuffer(GLenum target, GLuint buffer);
+void glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+void glEnableVertexAttribArray(GLuint index);
+void glDisableVertexAttribArray(GLuint index);
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+
+// Textures
+void glGenTextures(GLsizei n, GLuint* textures);
+void glDeleteTextures(GLsizei n, const GLuint* textures);
+void glActiveTexture(GLenum texture);
+void glBindTexture(GLenum target, GLuint texture);
+void glTexParameteri(GLenum target, GLenum pname, GLint param);
+void glPixelStorei(GLenum pname, GLint param);
+void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                  GLint border, GLenum format, GLenum type, const void* pixels);
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+                     GLenum format, GLenum type, const void* pixels);
+
+// Fixed-function state and drawing
+void glEnable(GLenum cap);
+void glDisable(GLenum cap);
+void glBlendFunc(GLenum sfactor, GLenum dfactor);
+void glLineWidth(GLfloat width);
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha);
+void glClear(GLbitfield mask);
+void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+
+// What the recorded calls would have cost a real driver
+struct GLRecordStats {
+    int calls = 0;            // every recorded GL call
+    int draw_calls = 0;
+    long long vertices = 0;
+    int state_changes = 0;    // binds, enables, blend, attribute setup, viewport...
+    int uniform_uploads = 0;
+    int location_queries = 0;
+    int buffer_uploads = 0;
+    size_t buffer_bytes = 0;
+    int texture_uploads = 0;
+    size_t texture_bytes = 0;
+};
+
+// Counters since the previous call, then resets them; call once per frame
+GLRecordStats gl_record_take_frame();
+
+#endif // GL_RECORD_H
@@ -1,5 +1,5 @@
 #include <SDL.h>
-#include <SDL_opengles2.h>
+#include "gl.h"
 #include <emscripten.h>
 #include <cmath>
 #include <vector>
@@ -13,7 +13,7 @@
 #include "battle.h"
 
 GameState g_state;
-BattleState g_battle;
+BattleSession g_battle;
 GameMode g_mode = GameMode::OVERWORLD;
 
 GameMode get_mode() {
@@ -22,12 +22,28 @@ GameMode get_mode() {
 
 void set_mode(GameMode mode) {
     g_mode = mode;
+    request_redraw();
+}
+
+// ImGui needs a few frames after input for hover and layout to settle
+static const int REDRAW_SETTLE_FRAMES = 3;
+// While idle the loop only wakes this often (ms) to look for events
+static const int IDLE_POLL_MS = 50;
+static int g_redraw_frames = REDRAW_SETTLE_FRAMES;
+static bool g_idle_timing = false;
+
+void request_redraw() {
+    g_redraw_frames = REDRAW_SETTLE_FRAMES;
 }
 
 // Global variables
 SDL_Window* window;
 SDL_GLContext context;
 GLuint program;
+GLuint meshProgram;
+GLuint tilemapProgram;
+GLuint particleProgram;
+GLuint shapeProgram;
 GLuint triangleVbo;
 GLuint circleVbo;
 GLuint squareVbo;
@@ -36,8 +52,9 @@ GLuint lineVbo;
 const char* vertex_shader_source = 
     "attribute vec2 position;\n"
     "uniform mat3 transform;\n"
+    "uniform mat3 view;\n"
     "void main() {\n"
-    "   vec3 pos = transform * vec3(position, 1.0);\n"
+    "   vec3 pos = view * transform * vec3(position, 1.0);\n"
     "   gl_Position = vec4(pos.xy, 0.0, 1.0);\n"
     "}\n";
 
@@ -48,6 +65,123 @@ const char* fragment_shader_source =
     "   gl_FragColor = color;\n"
     "}\n";
 
+// Baked meshes carry their colour per vertex
+const char* mesh_vertex_shader_source =
+    "attribute vec2 position;\n"
+    "attribute vec4 color;\n"
+    "uniform mat3 transform;\n"
+    "uniform mat3 view;\n"
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "   vec3 pos = view * transform * vec3(position, 1.0);\n"
+    "   gl_Position = vec4(pos.xy, 0.0, 1.0);\n"
+    "   v_color = color;\n"
+    "}\n";
+
+const char* mesh_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "   gl_FragColor = v_color;\n"
+    "}\n";
+
+// Particles are round GL_POINTS fading with their vertex alpha
+const char* particle_vertex_shader_source =
+    "attribute vec2 position;\n"
+    "attribute vec4 color;\n"
+    "uniform mat3 transform;\n"
+    "uniform mat3 view;\n"
+    "uniform float point_size;\n"
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "   vec3 pos = view * transform * vec3(position, 1.0);\n"
+    "   gl_Position = vec4(pos.xy, 0.0, 1.0);\n"
+    "   gl_PointSize = point_size;\n"
+    "   v_color = color;\n"
+    "}\n";
+
+const char* particle_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "   vec2 d = gl_PointCoord - vec2(0.5);\n"
+    "   float falloff = 1.0 - smoothstep(0.2, 0.25, dot(d, d));\n"
+    "   gl_FragColor = vec4(v_color.rgb, v_color.a * falloff);\n"
+    "}\n";
+
+// PrimitiveBatch shapes: per-vertex colour, and discs cut out of their quad
+// by distance with about a pixel of antialiased edge
+const char* shape_vertex_shader_source =
+    "attribute vec2 position;\n"
+    "attribute vec4 color;\n"
+    "attribute vec3 shape;\n"
+    "uniform mat3 transform;\n"
+    "uniform mat3 view;\n"
+    "varying vec4 v_color;\n"
+    "varying vec3 v_shape;\n"
+    "void main() {\n"
+    "   vec3 pos = view * transform * vec3(position, 1.0);\n"
+    "   gl_Position = vec4(pos.xy, 0.0, 1.0);\n"
+    "   v_color = color;\n"
+    "   v_shape = shape;\n"
+    "}\n";
+
+const char* shape_fragment_shader_source =
+    "precision mediump float;\n"
+    "varying vec4 v_color;\n"
+    "varying vec3 v_shape;\n"
+    "void main() {\n"
+    "   float coverage = clamp((1.0 - length(v_shape.xy)) / v_shape.z, 0.0, 1.0);\n"
+    "   gl_FragColor = vec4(v_color.rgb, v_color.a * coverage);\n"
+    "}\n";
+
+// Full-screen tilemap: position is the quad in clip space
+const char* tilemap_vertex_shader_source =
+    "attribute vec2 position;\n"
+    "uniform mat3 transform;\n"
+    "uniform mat3 view;\n"
+    "varying vec2 v_ndc;\n"
+    "void main() {\n"
+    "   vec3 pos = view * transform * vec3(position, 1.0);\n"
+    "   gl_Position = vec4(pos.xy, 0.0, 1.0);\n"
+    "   v_ndc = pos.xy;\n"
+    "}\n";
+
+// Tile ids match the Tiles enum. Planets overhang their tile (radius 0.9),
+// so the 3x3 neighbourhood is checked for planet centres.
+const char* tilemap_fragment_shader_source =
+    "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+    "precision highp float;\n"
+    "#else\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "uniform sampler2D tiles;\n"
+    "uniform float texture_tiles;\n"
+    "uniform vec2 cam_offset;\n"
+    "uniform vec2 anchor_mod;\n"
+    "uniform vec2 half_extent;\n"
+    "varying vec2 v_ndc;\n"
+    "float tile_at(vec2 tile) {\n"
+    "   vec2 uv = (mod(tile + anchor_mod, texture_tiles) + 0.5) / texture_tiles;\n"
+    "   return floor(texture2D(tiles, uv).r * 255.0 + 0.5);\n"
+    "}\n"
+    "void main() {\n"
+    "   vec2 world = cam_offset + v_ndc * half_extent;\n"
+    "   vec2 tile = floor(world);\n"
+    "   float id = tile_at(tile);\n"
+    "   vec4 color = vec4(0.0);\n"
+    "   if (id == 1.0) color = vec4(1.0, 0.0, 0.0, 0.3);\n"
+    "   else if (id == 5.0) color = vec4(0.5, 0.5, 0.0, 1.0);\n"
+    "   else if (id == 3.0 && distance(world, tile + 0.5) < 0.1) color = vec4(0.5, 0.5, 0.5, 1.0);\n"
+    "   for (int dx = -1; dx <= 1; ++dx) {\n"
+    "       for (int dy = -1; dy <= 1; ++dy) {\n"
+    "           vec2 n = tile + vec2(float(dx), float(dy));\n"
+    "           if (tile_at(n) == 2.0 && distance(world, n + 0.5) < 0.9) color = vec4(0.0, 0.5, 1.0, 1.0);\n"
+    "       }\n"
+    "   }\n"
+    "   gl_FragColor = color;\n"
+    "}\n";
+
 GLuint compile_shader(GLenum type, const char* source) {
     GLuint shader = glCreateShader(type);
     glShaderSource(shader, 1, &source, nullptr);
@@ -56,6 +190,27 @@ GLuint compile_shader(GLenum type, const char* source) {
 }
 
 void main_loop() {
+    // Peek only: the mode loops poll and handle the events themselves
+    SDL_PumpEvents();
+    if (SDL_PeepEvents(nullptr, 0, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0) {
+        request_redraw();
+    }
+    if (get_mode() == GameMode::BATTLE) battle_background_work();
+    if (g_redraw_frames == 0) {
+        // Nothing changed: keep the last frame, and stop asking for one per
+        // display refresh until something does
+        if (!g_idle_timing) {
+            emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, IDLE_POLL_MS);
+            g_idle_timing = true;
+        }
+        return;
+    }
+    if (g_idle_timing) {
+        emscripten_set_main_loop_timing(EM_TIMING_RAF, 1);
+        g_idle_timing = false;
+    }
+    g_redraw_frames--;
+
     GameMode mode = get_mode();
     
     switch (mode) {
@@ -100,6 +255,34 @@ int main() {
     glAttachShader(program, fs);
     glLinkProgram(program);
 
+    GLuint mesh_vs = compile_shader(GL_VERTEX_SHADER, mesh_vertex_shader_source);
+    GLuint mesh_fs = compile_shader(GL_FRAGMENT_SHADER, mesh_fragment_shader_source);
+    meshProgram = glCreateProgram();
+    glAttachShader(meshProgram, mesh_vs);
+    glAttachShader(meshProgram, mesh_fs);
+    glLinkProgram(meshProgram);
+
+    GLuint tilemap_vs = compile_shader(GL_VERTEX_SHADER, tilemap_vertex_shader_source);
+    GLuint tilemap_fs = compile_shader(GL_FRAGMENT_SHADER, tilemap_fragment_shader_source);
+    tilemapProgram = glCreateProgram();
+    glAttachShader(tilemapProgram, tilemap_vs);
+    glAttachShader(tilemapProgram, tilemap_fs);
+    glLinkProgram(tilemapProgram);
+
+    GLuint particle_vs = compile_shader(GL_VERTEX_SHADER, particle_vertex_shader_source);
+    GLuint particle_fs = compile_shader(GL_FRAGMENT_SHADER, particle_fragment_shader_source);
+    particleProgram = glCreateProgram();
+    glAttachShader(particleProgram, particle_vs);
+    glAttachShader(particleProgram, particle_fs);
+    glLinkProgram(particleProgram);
+
+    GLuint shape_vs = compile_shader(GL_VERTEX_SHADER, shape_vertex_shader_source);
+    GLuint shape_fs = compile_shader(GL_FRAGMENT_SHADER, shape_fragment_shader_source);
+    shapeProgram = glCreateProgram();
+    glAttachShader(shapeProgram, shape_vs);
+    glAttachShader(shapeProgram, shape_fs);
+    glLinkProgram(shapeProgram);
+
     // Geometry - Triangle (pointing right at 0 degrees)
     float triangle_verts[] = {
          1.0f,  0.0f,
@@ -1,14 +1,17 @@
 #include "overworld.h"
 #include <emscripten.h>
+#include <algorithm>
 #include <cmath>
 #include <random>
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_opengl3.h"
 #include "geometry.h"
+#include "world_render.h"
+#include "particles.h"
 
-const float TILE_SIZE = 1.0f;
-const int GRID_VIEW_RANGE = 20;
+// World-unit particles: thruster trails and the like
+static ParticleSystem world_particles;
 
 void overworld_loop() {
     //ensure_default_player_deck(g_state.player);
@@ -18,141 +21,13 @@ void overworld_loop() {
     render_game();
 }
 
-Chunk::Chunk() {
-    for (int x = 0; x < SIZE; ++x) {
-        for (int y = 0; y < SIZE; ++y) {
-            tiles[x][y] = Tiles::EMPTY;
-        }
-    }
-}
-Tiles Chunk::get_tile(int x, int y) const {
-    if (x < 0 || x >= SIZE || y < 0 || y >= SIZE) {
-        return Tiles::EMPTY;
-    }
-    return tiles[x][y];
-}
-int PlanetGenerator::hash(int x, int y) const {
-    int h = g_state.seed;
-    h ^= x * 73856093ULL;
-    h ^= y * 19349663ULL;
-    h ^= (h >> 13);
-    h *= 0xc4ceb9fe1a85ec53ULL;
-    h ^= (h >> 13);
-    return h;
-}
-Point PlanetGenerator::get_planet_in_cell(int cell_x, int cell_y) const {
-    int h = hash(cell_x, cell_y);
-    uint64_t seed = hash(cell_x, cell_y);
-    int offsetX = seed % cell_size;
-    int offsetY = (seed >> 16) % cell_size;
-    return {cell_x * cell_size + offsetX, cell_y * cell_size + offsetY};
-}
-bool PlanetGenerator::is_planet_at(int tile_x, int tile_y) const {
-    auto [cell_x, cell_y] = tile_to_cell(tile_x, tile_y);
-    auto [planet_x, planet_y] = get_planet_in_cell(cell_x, cell_y);
-    return (planet_x == tile_x && planet_y == tile_y);
-}
-WorldMap::WorldMap(int seed) {
-    // Initial world generation can be done here if needed
-    terrainNoise.SetSeed(seed);
-    terrainNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2S);
-    terrainNoise.SetFrequency(0.03f); // Controls how "big" the zones are
-    terrainNoise.SetFractalType(FastNoiseLite::FractalType_Ridged);
-    terrainNoise.SetFractalOctaves(2);
-    terrainNoise.SetFractalLacunarity(1.0f);
-    terrainNoise.SetFractalGain(35.0f);
-    terrainNoise.SetFractalWeightedStrength(0.07f);
-    terrainNoise.SetDomainWarpType(FastNoiseLite::DomainWarpType_OpenSimplex2);
-    terrainNoise.SetDomainWarpAmp(2.5f);
-   
-
-    asteroidNoise.SetSeed(seed);
-    asteroidNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-    asteroidNoise.SetFrequency(0.3f); // Controls how "big" the zones are
-    // terrainNoise.SetCellularReturnType(FastNoiseLite::CellularReturnType_CellValue);
-    // terrainNoise.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Hybrid);
-
-    pathNoise.SetSeed(seed + 123);
-    pathNoise.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-    pathNoise.SetFractalType(FastNoiseLite::FractalType_Ridged);
-    pathNoise.SetFrequency(0.005f); // Controls path density
-}
-Tiles WorldMap::get_tile_at(int x, int y) {
-    int chunk_x = x / Chunk::SIZE;
-    int chunk_y = y / Chunk::SIZE;
-    int local_x = x % Chunk::SIZE;
-    int local_y = y % Chunk::SIZE;
-
-    auto it = chunks.find({chunk_x, chunk_y});
-    if (it == chunks.end()) {
-        generate_chunk(chunk_x, chunk_y);
-        it = chunks.find({chunk_x, chunk_y});
-    }
-    return it->second.get_tile(local_x, local_y);
-}
-void WorldMap::set_active_chunks() {
-    // std::vector<std::pair<Point, Chunk>> active_chunks;
-    float camX = g_state.player.x;
-    float camY = g_state.player.y;
-    float aspect = (float)g_state.screen_width / (float)g_state.screen_height;
-    float zoom = g_state.zoom.level;
-    auto [start_tile, end_tile] = get_visible_tile_range(camX, camY, aspect, zoom);
-    int start_chunk_x = std::floor((TILE_SIZE * start_tile.first) / Chunk::SIZE);
-    int end_chunk_x = std::ceil((TILE_SIZE * end_tile.first) / Chunk::SIZE);
-    int start_chunk_y = std::floor((TILE_SIZE * start_tile.second) / Chunk::SIZE);
-    int end_chunk_y = std::ceil((TILE_SIZE * end_tile.second) / Chunk::SIZE);
-    this->active_chunks.clear();
-    for (int cx = start_chunk_x; cx <= end_chunk_x; ++cx) {
-        for (int cy = start_chunk_y; cy <= end_chunk_y; ++cy) {
-            auto it = chunks.find({cx, cy});
-            if (it == chunks.end()) {
-                generate_chunk(cx, cy);
-                it = chunks.find({cx, cy});
-            }
-            this->active_chunks.push_back({{cx, cy}, it->second});
-        }
-    }
-}
-
-void WorldMap::generate_chunk(int chunk_x, int chunk_y) {
-    Chunk new_chunk;
-    for (int x = 0; x < Chunk::SIZE; ++x) {
-        for (int y = 0; y < Chunk::SIZE; ++y) {
-            int world_x = chunk_x * Chunk::SIZE + x;
-            int world_y = chunk_y * Chunk::SIZE + y;
-
-            float terrain_value = terrainNoise.GetNoise((float)world_x, (float)world_y);
-            float asteroid_value = asteroidNoise.GetNoise((float)world_x, (float)world_y);
-            float path_value = pathNoise.GetNoise((float)world_x, (float)world_y);
-
-            static std::mt19937 ruin_rng(time(0));
-            std::uniform_int_distribution<int> dist(1, 100);
-            if (terrain_value > 0.5f) {
-                if (pl_gen.is_planet_at(world_x, world_y)) {
-                    new_chunk.tiles[x][y] = Tiles::PLANET;
-                } else if (asteroid_value > 0.4f) {
-                    new_chunk.tiles[x][y] = Tiles::ASTEROID;
-                } else {
-                    new_chunk.tiles[x][y] = Tiles::EMPTY;
-                }
-            } else if (terrain_value < -0.7f && dist(ruin_rng) <= 1) {
-                new_chunk.tiles[x][y] = Tiles::RESOURCES;
-            } 
-            else {
-                new_chunk.tiles[x][y] = Tiles::DANGEROUS;
-            }
-        }
-    }
-    chunks[{chunk_x, chunk_y}] = new_chunk;
-}
-
-std::pair<Point, Point> WorldMap::get_visible_tile_range(float camX, float camY, float aspect, float zoom) {
-    int viewRange = (int)(2 / zoom);
-    int startX = (int)floor((camX - viewRange * TILE_SIZE) / TILE_SIZE);
-    int endX = (int)ceil((camX + viewRange * TILE_SIZE) / TILE_SIZE);
-    int startY = (int)floor((camY - viewRange * TILE_SIZE) / TILE_SIZE);
-    int endY = (int)ceil((camY + viewRange * TILE_SIZE) / TILE_SIZE);
-    return {{startX, startY}, {endX, endY}};
+Camera game_camera() {
+    Camera camera;
+    camera.x = g_state.player.x;
+    camera.y = g_state.player.y;
+    camera.aspect = (float)g_state.screen_width / (float)g_state.screen_height;
+    camera.zoom = g_state.zoom.level;
+    return camera;
 }
 
 void handle_events() {
@@ -191,6 +66,18 @@ void handle_events() {
             }
 
             if (moved) {
+                // Thruster puff out of the back of the ship
+                ParticleBurst thrust;
+                thrust.x = g_state.player.x;
+                thrust.y = g_state.player.y;
+                thrust.count = 24;
+                thrust.speed = 3.0f * TILE_SIZE;
+                thrust.angle = g_state.player.angle + M_PI;
+                thrust.spread = 0.8f;
+                thrust.life = 0.5f;
+                thrust.r = 1.0f; thrust.g = 0.6f; thrust.b = 0.2f;
+                world_particles.emit(thrust);
+
                 // Not a fan of this
                 static std::mt19937 battle_rng(time(0));
                 std::uniform_int_distribution<int> dist(1, 50);
@@ -198,19 +85,16 @@ void handle_events() {
                 if (dist(battle_rng) == 1) {
                     start_random_battle(g_state.player.deck, g_state.player.difficulty);
                 }
-                g_state.world_map.set_active_chunks();
             }
 
             // Zoom controls
             if (event.key.keysym.scancode == SDL_SCANCODE_EQUALS || event.key.keysym.scancode == SDL_SCANCODE_KP_PLUS) {
                 g_state.zoom.level += g_state.zoom.speed;
                 if (g_state.zoom.level > g_state.zoom.max) g_state.zoom.level = g_state.zoom.max;
-                g_state.world_map.set_active_chunks();
             }
             if (event.key.keysym.scancode == SDL_SCANCODE_MINUS || event.key.keysym.scancode == SDL_SCANCODE_KP_MINUS) {
                 g_state.zoom.level -= g_state.zoom.speed;
                 if (g_state.zoom.level < g_state.zoom.min) g_state.zoom.level = g_state.zoom.min;
-                g_state.world_map.set_active_chunks();
             }
         }
         if (event.type == SDL_KEYUP) {
@@ -220,38 +104,15 @@ void handle_events() {
     }
 }
 
-void draw_grid(float camX, float camY, float aspect, float zoom) {
-    int viewRange = (int)(GRID_VIEW_RANGE / zoom);
-    int startX = (int)floor((camX - viewRange * TILE_SIZE) / TILE_SIZE);
-    int endX = (int)ceil((camX + viewRange * TILE_SIZE) / TILE_SIZE);
-    int startY = (int)floor((camY - viewRange * TILE_SIZE) / TILE_SIZE);
-    int endY = (int)ceil((camY + viewRange * TILE_SIZE) / TILE_SIZE);
+void draw_planets(const Camera& camera) {
+    // One camera-space batch: positions relative to the anchor, in world units
+    const CameraAnchor& anchor = get_camera_anchor();
+    PrimitiveBatch planets(camera.zoom * g_state.screen_height * 0.5f);
+    // Largest disc is 0.45 tiles, so it never leaves its own tile
+    TileRect tiles = camera.tile_range();
 
-    for (int x = startX; x <= endX; ++x) {
-        float worldX = x * TILE_SIZE;
-        float screenX = (worldX - camX) / (aspect / zoom);
-        float screenY1 = (startY * TILE_SIZE - camY) / (1.0f / zoom);
-        float screenY2 = (endY * TILE_SIZE - camY) / (1.0f / zoom);
-        draw_line(lineVbo, screenX, screenY1, screenX, screenY2, 0.2f, 0.2f, 0.3f, program, aspect);
-    }
-    for (int y = startY; y <= endY; ++y) {
-        float worldY = y * TILE_SIZE;
-        float screenY = (worldY - camY) / (1.0f / zoom);
-        float screenX1 = (startX * TILE_SIZE - camX) / (aspect / zoom);
-        float screenX2 = (endX * TILE_SIZE - camX) / (aspect / zoom);
-        draw_line(lineVbo, screenX1, screenY, screenX2, screenY, 0.2f, 0.2f, 0.3f, program, aspect);
-    }
-}
-
-void draw_planets(float camX, float camY, float aspect, float zoom) {
-    int viewRange = (int)(GRID_VIEW_RANGE / zoom);
-    int startX = (int)floor((camX - viewRange * TILE_SIZE) / TILE_SIZE);
-    int endX = (int)ceil((camX + viewRange * TILE_SIZE) / TILE_SIZE);
-    int startY = (int)floor((camY - viewRange * TILE_SIZE) / TILE_SIZE);
-    int endY = (int)ceil((camY + viewRange * TILE_SIZE) / TILE_SIZE);
-
-    for (int x = startX; x <= endX; ++x) {
-        for (int y = startY; y <= endY; ++y) {
+    for (int x = tiles.min_x; x <= tiles.max_x; ++x) {
+        for (int y = tiles.min_y; y <= tiles.max_y; ++y) {
             std::mt19937 tile_rng(static_cast<unsigned int>(x * 73856093 ^ y * 19349663));
             std::uniform_real_distribution<float> chance_dist(0.0f, 1.0f);
             
@@ -264,32 +125,83 @@ void draw_planets(float camX, float camY, float aspect, float zoom) {
                 float g = col_dist(tile_rng);
                 float b = col_dist(tile_rng);
                 
-                float worldX = x * TILE_SIZE + TILE_SIZE * 0.5f;
-                float worldY = y * TILE_SIZE + TILE_SIZE * 0.5f;
-                
-                float screenX = (worldX - camX) / (aspect / zoom);
-                float screenY = (worldY - camY) / (1.0f / zoom);
-                draw_disc(circleVbo, screenX, screenY, radius * zoom, r, g, b, program, aspect);
+                float localX = (float)(x * TILE_SIZE + TILE_SIZE * 0.5f - anchor.x);
+                float localY = (float)(y * TILE_SIZE + TILE_SIZE * 0.5f - anchor.y);
+                planets.disc(localX, localY, radius, r, g, b, 1.0f);
             }
         }
     }
+    planets.submit(shapeProgram, true);
 }
 
-
 void debug_chunks() {
     ImGui::Begin("Active Chunks");
     ImGui::Text("Active Chunks:");
-
-    auto active_chunks = g_state.world_map.get_active_chunks();
-    for (const auto& chunk_pair : active_chunks) {
-        const Point& coord = chunk_pair.first;
-        ImGui::Text("   Chunk (%d, %d)", coord.first, coord.second);
+    Camera camera = game_camera();
+    ViewRect view = camera.view_rect();
+    TileRect visible = camera.tile_range();
+    const TileRect& active = g_state.world_map.get_active_range();
+    ImGui::Text("View: (%.1f, %.1f) - (%.1f, %.1f)", view.min_x, view.min_y, view.max_x, view.max_y);
+    ImGui::Text("Visible tiles: %d x %d", visible.width(), visible.height());
+    ImGui::Text("Active chunks: (%d, %d) - (%d, %d)", active.min_x, active.min_y, active.max_x, active.max_y);
+    ImGui::Checkbox("Tilemap renderer", &g_use_tilemap);
+    if (g_use_tilemap) {
+        ImGui::Text("Tilemap: %d chunk uploads on last sync", world_tilemap().uploads());
+    } else {
+        const ChunkMeshCache& chunk_meshes = world_chunk_meshes();
+        const CullStats& cull = chunk_meshes.cull_stats();
+        ImGui::Text("Meshes: %zu  Draw calls: %zu", chunk_meshes.size(), chunk_meshes.draw_calls());
+        ImGui::Text("Chunks: %d drawn, %d culled", cull.chunks_drawn, cull.chunks_culled);
+        ImGui::Text("Tiles: %d drawn, %d culled", cull.tiles_drawn, cull.tiles_culled);
     }
+    const RenderStats& render = get_render_stats();
+    ImGui::Text("Frame: %d commands, %d draws", render.commands, render.draw_calls);
+    ImGui::Text("State changes: %d issued, %d redundant skipped", render.state_changes, render.redundant_skipped);
+    ImGui::Text("Streamed: %zu bytes, %d draws merged", render.stream_bytes, render.merged_draws);
+    ImGui::Text("Particles: %d live, %d dropped", world_particles.count(), world_particles.dropped());
+
+    const auto& active_chunks = g_state.world_map.get_active_chunks();
+    if (ImGui::BeginChild("ActiveChunkList", ImVec2(0, 120), true)) {
+        ImGuiListClipper clipper;
+        clipper.Begin((int)active_chunks.size());
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const Point& coord = active_chunks[i].first;
+                ImGui::Text("   Chunk (%d, %d)", coord.first, coord.second);
+            }
+        }
+        clipper.End();
+    }
+    ImGui::EndChild();
+
     ImGui::Text("All Chunks:");
-    for (const auto& chunk_pair : g_state.world_map.chunks) {
-        const Point& coord = chunk_pair.first;
-        ImGui::Text("   Chunk (%d, %d)", coord.first, coord.second);
+    ChunkStore::Stats stats = g_state.world_map.chunks.stats();
+    ImGui::Text("Pool: %zu/%zu slots in %zu slabs (peak %zu)", stats.pool.live, stats.pool.capacity, stats.pool.slabs, stats.pool.high_water);
+    ImGui::Text("Recycled: %zu  Evicted: %zu  Retired: %zu", stats.pool.recycled, stats.evicted, stats.retired);
+    // The store only changes when chunks are generated or evicted, so the
+    // coordinate list is gathered again only then
+    static std::vector<Point> stored_chunks;
+    static size_t stored_live = ~(size_t)0;
+    static size_t stored_evicted = ~(size_t)0;
+    if (stats.pool.live != stored_live || stats.evicted != stored_evicted) {
+        stored_chunks.clear();
+        g_state.world_map.chunks.for_each([](const Point& coord, const Chunk&) {
+            stored_chunks.push_back(coord);
+        });
+        stored_live = stats.pool.live;
+        stored_evicted = stats.evicted;
     }
+    if (ImGui::BeginChild("StoredChunkList", ImVec2(0, 160), true)) {
+        ImGuiListClipper clipper;
+        clipper.Begin((int)stored_chunks.size());
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                ImGui::Text("   Chunk (%d, %d)", stored_chunks[i].first, stored_chunks[i].second);
+            }
+        }
+        clipper.End();
+    }
+    ImGui::EndChild();
     ImGui::End();
 }
 
@@ -308,9 +220,15 @@ void render_ui() {
     ImGui::Separator();
     ImGui::Text("Deck (%zu cards):", g_state.player.deck.size());
     if (ImGui::BeginChild("DeckList", ImVec2(0, 150), true)) {
-        for (const auto& card : g_state.player.deck) {
-            ImGui::TextUnformatted(card.name.c_str());
+        const auto& deck = g_state.player.deck;
+        ImGuiListClipper clipper;
+        clipper.Begin((int)deck.size());
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                ImGui::TextUnformatted(card_def(deck[i]).name);
+            }
         }
+        clipper.End();
     }
     ImGui::EndChild();
     ImGui::End();
@@ -319,59 +237,6 @@ void render_ui() {
     
     ImGui::Render();
 }
-void draw_tile(int tile_x, int tile_y, Tiles tile_type, float camX, float camY, float aspect, float zoom) {
-    float worldX = ((float)tile_x + 0.5f) * TILE_SIZE;
-    float worldY = ((float)tile_y + 0.5f) * TILE_SIZE;
-    float screenX = (worldX - camX) / (aspect / zoom);
-    float screenY = (worldY - camY) / (1.0f / zoom);
-
-    switch (tile_type) {
-        case Tiles::PLANET:
-            draw_disc(circleVbo, screenX, screenY, 0.9f * zoom, 0.0f, 0.5f, 1.0f, program, aspect);
-            break;
-        case Tiles::ASTEROID:
-            // Draw a couple of small circles to represent an asteroid
-            draw_disc(circleVbo, screenX, screenY, 0.1f * zoom, 0.5f, 0.5f, 0.5f, program, aspect);
-            break;
-        case Tiles::DANGEROUS:
-            // Color the entire tile red
-            screenX = (tile_x - camX) / (aspect / zoom);
-            screenY = (tile_y - camY) / (1.0f / zoom);
-            draw_square(squareVbo, screenX, screenY, TILE_SIZE * zoom, 1.0f, 0.0f, 0.0f, 0.3f, program, aspect);
-        
-            break;
-        case Tiles::RESOURCES:
-            // Color the entire tile red
-            screenX = (tile_x - camX) / (aspect / zoom);
-            screenY = (tile_y - camY) / (1.0f / zoom);
-            // draw yellow square
-            draw_square(squareVbo, screenX, screenY, TILE_SIZE * zoom, 0.5f, 0.5f, 0.0f, 1.0f, program, aspect);
-        
-            break;
-        default:
-            break;
-    }
-
-}
-void draw_map(float camX, float camY, float aspect, float zoom) {
-    auto active_chunks = g_state.world_map.get_active_chunks();
-    for (const auto& chunk_pair : active_chunks) {
-        const Point& chunk_coord = chunk_pair.first;
-        const Chunk& chunk = chunk_pair.second;
-        auto [i, j] = chunk_coord;
-        auto [world_chunk_x, world_chunk_y] = g_state.world_map.chunk_to_world(chunk_coord);
-        for (int x = 0; x < Chunk::SIZE; ++x) {
-            for (int y = 0; y < Chunk::SIZE; ++y) {
-                Tiles tile = chunk.get_tile(x, y);
-                // Render tile based on its type
-                // e.g., draw different shapes/colors for different tile types
-                draw_tile(world_chunk_x + x, world_chunk_y + y, tile, camX, camY, aspect, zoom);
-            }
-        }
-    }
-    
-}
-
 void render_game() {
     SDL_GetWindowSize(window, &g_state.screen_width, &g_state.screen_height);
     glViewport(0, 0, g_state.screen_width, g_state.screen_height);
@@ -379,19 +244,33 @@ void render_game() {
     glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(program);
-
-    float camX = g_state.player.x;
-    float camY = g_state.player.y;
-    float aspect = (float)g_state.screen_width / (float)g_state.screen_height;
-    float zoom = g_state.zoom.level;
-
-    draw_grid(camX, camY, aspect, zoom);
-    draw_map(camX, camY, aspect, zoom);
-    // draw_planets(camX, camY, aspect, zoom);
+    Camera camera = game_camera();
+    float aspect = camera.aspect;
+    float zoom = camera.zoom;
+    // Picks up moves, zooms and window resizes alike
+    g_state.world_map.set_active_chunks(camera);
+
+    set_camera_view(camera.x, camera.y, aspect, zoom);
+    set_draw_layer(0);
+    draw_grid(camera, g_state.screen_height, meshProgram);
+    set_draw_layer(1);
+    draw_map(g_state.world_map, camera, meshProgram, tilemapProgram, squareVbo);
+    // draw_planets(camera);
+
+    // Particles live in world units; only the anchor offset is applied
+    world_particles.update(ImGui::GetIO().DeltaTime);
+    if (world_particles.count() > 0) request_redraw();
+    const CameraAnchor& anchor = get_camera_anchor();
+    float particle_transform[9];
+    make_transform(particle_transform, (float)-anchor.x, (float)-anchor.y, 1.0f, 1.0f);
+    set_draw_layer(2);
+    world_particles.draw(particleProgram, particle_transform, true, 4.0f);
 
     // Draw Player
-    draw_triangle(triangleVbo, 0.0f, 0.0f, 0.05f * zoom, g_state.player.angle, 1.0f, 1.0f, 1.0f, program, aspect);
-
+    set_draw_layer(3);
+    PrimitiveBatch player(g_state.screen_height * 0.5f);
+    player.triangle(0.0f, 0.0f, 0.05f * zoom, g_state.player.angle, 1.0f, 1.0f, 1.0f, aspect);
+    player.submit(shapeProgram);
 
+    flush_draw_commands();
 }
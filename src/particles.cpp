@@ -0,0 +1,88 @@
+#include "particles.h"
+#include "geometry.h"
+#include <algorithm>
+#include <cmath>
+
+float ParticleSystem::random01() {
+    // xorshift32, plenty for effects
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+static GLubyte channel(float v) {
+    return (GLubyte)std::lround(std::min(std::max(v, 0.0f), 1.0f) * 255.0f);
+}
+
+void ParticleSystem::emit(const ParticleBurst& burst) {
+    int count = std::min(burst.count, CAPACITY - live);
+    dropped_total += burst.count - count;
+    uint32_t color = channel(burst.r) | (channel(burst.g) << 8) | (channel(burst.b) << 16);
+    for (int i = 0; i < count; ++i) {
+        int p = live++;
+        float a = burst.angle + (random01() - 0.5f) * burst.spread;
+        float s = burst.speed * (0.2f + 0.8f * random01());
+        px[p] = burst.x;
+        py[p] = burst.y;
+        vx[p] = cosf(a) * s;
+        vy[p] = sinf(a) * s;
+        age[p] = 0.0f;
+        life[p] = burst.life * (0.5f + 0.5f * random01());
+        rgb[p] = color;
+    }
+}
+
+void ParticleSystem::update(float dt) {
+    float damp = std::max(0.0f, 1.0f - drag * dt);
+    int n = live;
+    for (int i = 0; i < n; ++i) age[i] += dt;
+    for (int i = 0; i < n; ++i) {
+        vx[i] *= damp;
+        vy[i] *= damp;
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+    }
+    // Compact: move the last live particle into each dead slot
+    for (int i = 0; i < n;) {
+        if (age[i] < life[i]) {
+            ++i;
+            continue;
+        }
+        --n;
+        px[i] = px[n];
+        py[i] = py[n];
+        vx[i] = vx[n];
+        vy[i] = vy[n];
+        age[i] = age[n];
+        life[i] = life[n];
+        rgb[i] = rgb[n];
+    }
+    live = n;
+}
+
+void ParticleSystem::set_uniforms(GLuint program, const void* user) {
+    const ParticleSystem* self = static_cast<const ParticleSystem*>(user);
+    glUniform1f(uniform_location(program, "point_size"), self->current_point_size);
+}
+
+void ParticleSystem::draw(GLuint program, const float transform[9], bool camera_space, float point_size) {
+    if (live == 0) return;
+
+    for (int i = 0; i < live; ++i) {
+        uint32_t c = rgb[i];
+        // Fade out over the lifetime
+        float fade = 1.0f - age[i] / life[i];
+        verts[i] = {px[i], py[i], (GLubyte)(c & 0xff), (GLubyte)((c >> 8) & 0xff), (GLubyte)((c >> 16) & 0xff),
+                    (GLubyte)(fade * 255.0f)};
+    }
+
+    current_point_size = point_size;
+    DrawCommand cmd = stream_draw(program, GL_POINTS, verts, live);
+    cmd.blend = true;
+    cmd.camera_space = camera_space;
+    cmd.custom_uniforms = &ParticleSystem::set_uniforms;
+    cmd.user = this;
+    std::copy(transform, transform + 9, cmd.transform);
+    submit_draw(cmd);
+}
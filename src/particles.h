@@ -0,0 +1,56 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "geometry.h"
+#include "gl.h"
+#include <cstdint>
+
+struct ParticleBurst {
+    float x = 0.0f, y = 0.0f;
+    int count = 32;
+    float speed = 1.0f;       // max initial speed, units per second
+    float spread = 6.2831853f; // cone width in radians, centred on angle
+    float angle = 0.0f;
+    float life = 0.6f;        // max lifetime in seconds
+    float r = 1.0f, g = 1.0f, b = 1.0f;
+};
+
+// Fixed-capacity particle pool. State is kept as parallel arrays so the
+// update is one linear pass over each field; dead particles are swapped
+// with the last live one, so live particles are always [0, count()).
+// Nothing is allocated after construction, and when full, new particles
+// are dropped.
+class ParticleSystem {
+public:
+    static const int CAPACITY = 65536;
+
+    void emit(const ParticleBurst& burst);
+    // Ages, moves and drags every particle, then drops the dead ones
+    void update(float dt);
+    // Streams live particles as GL_POINTS and records one draw; program
+    // needs `position`, `color` attributes and `transform`, `view`,
+    // `point_size` uniforms. transform maps particle units to the view
+    // (camera_space) or to clip space.
+    void draw(GLuint program, const float transform[9], bool camera_space, float point_size);
+    void clear() { live = 0; }
+
+    int count() const { return live; }
+    int dropped() const { return dropped_total; }
+
+private:
+    static void set_uniforms(GLuint program, const void* user);
+    float random01();
+
+    float px[CAPACITY], py[CAPACITY];
+    float vx[CAPACITY], vy[CAPACITY];
+    float age[CAPACITY], life[CAPACITY];
+    uint32_t rgb[CAPACITY]; // 0x00BBGGRR
+    ColorVertex verts[CAPACITY]; // draw() staging, one vertex per live particle
+    int live = 0;
+    int dropped_total = 0;
+    float drag = 2.0f;
+    float current_point_size = 1.0f;
+    uint32_t rng_state = 0x9e3779b9u;
+};
+
+#endif // PARTICLES_H
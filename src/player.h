@@ -3,13 +3,13 @@
 
 #include <SDL.h>
 #include <vector>
-#include "battle.h"
+#include "battle_sim.h"
 
 struct Player {
     float x = 0.5f; // Center of tile (0,0)
     float y = 0.5f;
     float angle = 0.0f;
-    std::vector<Card> deck;
+    std::vector<CardId> deck;
     int difficulty = 0;
 
     Player();
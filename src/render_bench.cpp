@@ -0,0 +1,187 @@
+// Headless render benchmark: flies a scripted path over a generated world
+// at several zoom levels through the recording GL backend and prints
+// per-frame counters as CSV, so render changes can be compared by numbers.
+//
+//   render_bench [--seed N] [--frames N] [--mesh] [--size WxH] [--particles]
+//
+// --frames is per zoom level; --mesh uses the chunk-mesh path instead of
+// the tilemap. A per-zoom summary goes to stderr. --particles instead keeps
+// about PARTICLE_TARGET particles alive and times update and draw per frame.
+
+#ifndef SPACEGAME_GL_RECORD
+#error "render_bench is built against the recording GL backend (SPACEGAME_GL_RECORD)"
+#endif
+
+#include "gl.h"
+#include "geometry.h"
+#include "particles.h"
+#include "world.h"
+#include "world_render.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const float ZOOM_LEVELS[] = {2.0f, 1.0f, 0.3f, 0.1f, 0.02f};
+static const int PARTICLE_TARGET = 50000;
+static const int PARTICLES_PER_BURST = 256;
+
+// Too large for the stack
+static ParticleSystem bench_particles;
+
+// Tops the pool back up to PARTICLE_TARGET every frame with bursts spread
+// over the screen, the way thrusters and hits emit them in game
+static int run_particles(int frames, int width, int height) {
+    GLuint particle_program = glCreateProgram();
+    gl_record_take_frame();
+
+    Camera camera;
+    camera.aspect = (float)width / (float)height;
+    const float transform[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    const float dt = 1.0f / 60.0f;
+    uint32_t rng = 0x2545F491u;
+
+    std::printf("frame,live,emitted,update_us,draw_us,draw_calls,vertices,buffer_bytes\n");
+    double total_update_us = 0.0, total_draw_us = 0.0;
+    long long total_live = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        int emitted = 0;
+        while (bench_particles.count() < PARTICLE_TARGET) {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            ParticleBurst burst;
+            burst.x = (rng & 0xffff) / 65536.0f * 20.0f - 10.0f;
+            burst.y = (rng >> 16) / 65536.0f * 20.0f - 10.0f;
+            burst.count = std::min(PARTICLES_PER_BURST, PARTICLE_TARGET - bench_particles.count());
+            burst.speed = 2.0f;
+            burst.life = 1.0f;
+            burst.r = 1.0f;
+            burst.g = 0.6f;
+            burst.b = 0.2f;
+            bench_particles.emit(burst);
+            emitted += burst.count;
+        }
+        int live = bench_particles.count();
+
+        auto start = std::chrono::steady_clock::now();
+        bench_particles.update(dt);
+        auto updated = std::chrono::steady_clock::now();
+        glViewport(0, 0, width, height);
+        set_camera_view(camera.x, camera.y, camera.aspect, camera.zoom);
+        bench_particles.draw(particle_program, transform, true, 4.0f);
+        flush_draw_commands();
+        auto drawn = std::chrono::steady_clock::now();
+        double update_us = std::chrono::duration<double, std::micro>(updated - start).count();
+        double draw_us = std::chrono::duration<double, std::micro>(drawn - updated).count();
+
+        GLRecordStats gl = gl_record_take_frame();
+        std::printf("%d,%d,%d,%.1f,%.1f,%d,%lld,%zu\n", frame, live, emitted, update_us, draw_us,
+                    gl.draw_calls, gl.vertices, gl.buffer_bytes);
+        total_update_us += update_us;
+        total_draw_us += draw_us;
+        total_live += live;
+    }
+    if (frames > 0) {
+        std::fprintf(stderr, "particles: %.0f live, %.1f us update, %.1f us draw per frame\n",
+                     (double)total_live / frames, total_update_us / frames, total_draw_us / frames);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int seed = 1;
+    int frames = 240;
+    int width = 800;
+    int height = 600;
+    bool particles = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--mesh") == 0) {
+            g_use_tilemap = false;
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            std::sscanf(argv[++i], "%dx%d", &width, &height);
+        } else if (std::strcmp(argv[i], "--particles") == 0) {
+            particles = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--seed N] [--frames N] [--mesh] [--size WxH] [--particles]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+    if (particles) return run_particles(frames, width, height);
+
+    // Program and buffer names only; the recorder doesn't compile anything
+    GLuint mesh_program = glCreateProgram();
+    GLuint tilemap_program = glCreateProgram();
+    GLuint shape_program = glCreateProgram();
+    GLuint quad_vbo;
+    glGenBuffers(1, &quad_vbo);
+    gl_record_take_frame();
+
+    WorldMap map(seed);
+    Camera camera;
+    camera.aspect = (float)width / (float)height;
+
+    std::printf("frame,zoom,x,y,draw_calls,vertices,state_changes,uniform_uploads,location_queries,"
+                "buffer_uploads,buffer_bytes,texture_uploads,texture_bytes,commands,merged_draws,cpu_us\n");
+    int frame = 0;
+    for (float zoom : ZOOM_LEVELS) {
+        camera.zoom = zoom;
+        GLRecordStats total;
+        double total_us = 0.0;
+        for (int f = 0; f < frames; ++f, ++frame) {
+            // Diagonal flight covering about a screen height per second at 60 fps
+            float speed = 1.0f / zoom / 60.0f;
+            camera.x += speed;
+            camera.y += speed * 0.5f;
+
+            auto start = std::chrono::steady_clock::now();
+            map.set_active_chunks(camera);
+            glViewport(0, 0, width, height);
+            glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            set_camera_view(camera.x, camera.y, camera.aspect, camera.zoom);
+            set_draw_layer(0);
+            draw_grid(camera, height, mesh_program);
+            set_draw_layer(1);
+            draw_map(map, camera, mesh_program, tilemap_program, quad_vbo);
+            set_draw_layer(3);
+            PrimitiveBatch player(height * 0.5f);
+            player.triangle(0.0f, 0.0f, 0.05f * zoom, 0.0f, 1.0f, 1.0f, 1.0f, camera.aspect);
+            player.submit(shape_program);
+            flush_draw_commands();
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+            GLRecordStats gl = gl_record_take_frame();
+            const RenderStats& render = get_render_stats();
+            std::printf("%d,%.2f,%.2f,%.2f,%d,%lld,%d,%d,%d,%d,%zu,%d,%zu,%d,%d,%.1f\n",
+                        frame, zoom, camera.x, camera.y, gl.draw_calls, gl.vertices, gl.state_changes,
+                        gl.uniform_uploads, gl.location_queries, gl.buffer_uploads, gl.buffer_bytes,
+                        gl.texture_uploads, gl.texture_bytes, render.commands, render.merged_draws, us);
+
+            total.draw_calls += gl.draw_calls;
+            total.vertices += gl.vertices;
+            total.state_changes += gl.state_changes;
+            total.uniform_uploads += gl.uniform_uploads;
+            total.buffer_bytes += gl.buffer_bytes;
+            total.texture_bytes += gl.texture_bytes;
+            total_us += us;
+        }
+        if (frames > 0) {
+            std::fprintf(stderr,
+                         "zoom %5.2f: %.1f draws, %.0f verts, %.1f state changes, %.1f uniforms, "
+                         "%.0f buffer B, %.0f texture B, %.1f us per frame\n",
+                         zoom, (double)total.draw_calls / frames, (double)total.vertices / frames,
+                         (double)total.state_changes / frames, (double)total.uniform_uploads / frames,
+                         (double)total.buffer_bytes / frames, (double)total.texture_bytes / frames,
+                         total_us / frames);
+        }
+    }
+    return 0;
+}
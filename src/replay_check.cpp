@@ -0,0 +1,105 @@
+// Replays recorded battles headlessly and checks each ends in the recorded
+// state.
+//
+//   replay_check [--log] FILE...
+//
+// FILE holds a replay in binary or as the base64 text the game copies to
+// the clipboard; "-" reads stdin. --log prints the battle log of each.
+// Exits non-zero if any replay fails to load, rejects an input or ends in
+// a different state.
+
+#include "battle_replay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static bool read_input(const char* path, std::vector<uint8_t>& out) {
+    if (std::strcmp(path, "-") == 0) {
+        out.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        return true;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool load_replay(const std::vector<uint8_t>& bytes, BattleReplay& replay, std::string& error) {
+    if (bytes.size() >= 4 && std::memcmp(bytes.data(), "SGRP", 4) == 0) {
+        return decode_replay(bytes.data(), bytes.size(), replay, error);
+    }
+    return replay_from_text(std::string(bytes.begin(), bytes.end()), replay, error);
+}
+
+int main(int argc, char** argv) {
+    bool print_log = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--log") == 0) print_log = true;
+        else paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr, "usage: %s [--log] FILE...\n", argv[0]);
+        return 2;
+    }
+
+    int failures = 0;
+    for (const char* path : paths) {
+        std::vector<uint8_t> bytes;
+        BattleReplay replay;
+        std::string error;
+        if (!read_input(path, bytes)) {
+            std::printf("%s: cannot read\n", path);
+            failures++;
+            continue;
+        }
+        if (!load_replay(bytes, replay, error)) {
+            std::printf("%s: %s\n", path, error.c_str());
+            failures++;
+            continue;
+        }
+
+        BattleEventLog events;
+        std::vector<BattleEvent> log;
+        BattleState state;
+        if (print_log) state.events = &events;
+        // Copies each turn's events out so long battles don't wrap the ring
+        auto drain = [&](const BattleState&) {
+            for (uint32_t seq = events.first(); seq < events.total; ++seq) log.push_back(events.at(seq));
+            events.clear();
+        };
+        auto start = std::chrono::steady_clock::now();
+        bool ok = print_log ? run_replay(replay, state, drain) : run_replay(replay, state);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (print_log) drain(state);
+        for (const BattleEvent& event : log) {
+            std::string line = format_battle_event(event);
+            if (!line.empty()) std::printf("  %s\n", line.c_str());
+        }
+
+        uint64_t hash = battle_state_hash(state);
+        const char* result = state.player.hp <= 0 && state.opponent.hp <= 0 ? "draw"
+                           : state.opponent.hp <= 0                         ? "player won"
+                           : state.player.hp <= 0                           ? "opponent won"
+                                                                            : "unfinished";
+        std::printf("%s: seed %llu, %zu turns, %s (%d vs %d HP), %.3f ms\n", path,
+                    (unsigned long long)replay.seed, replay.turns.size(), result,
+                    state.player.hp, state.opponent.hp, ms);
+        if (!ok) {
+            std::printf("%s: an input was rejected\n", path);
+            failures++;
+        } else if (hash != replay.final_hash) {
+            std::printf("%s: MISMATCH state hash %016llx, recorded %016llx\n", path,
+                        (unsigned long long)hash, (unsigned long long)replay.final_hash);
+            failures++;
+        } else {
+            std::printf("%s: OK %016llx\n", path, (unsigned long long)hash);
+        }
+    }
+    return failures ? 1 : 0;
+}
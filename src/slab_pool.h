@@ -0,0 +1,107 @@
+#ifndef SLAB_POOL_H
+#define SLAB_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+struct SlabPoolStats {
+    size_t slabs = 0;
+    size_t capacity = 0;   // slots across all slabs
+    size_t live = 0;
+    size_t high_water = 0; // most slots ever live at once
+    size_t recycled = 0;   // allocations served from a freed slot
+};
+
+// Fixed-size object pool. Objects live in slabs of SLAB_SIZE slots that are
+// never returned to the heap, so streaming chunks in and out of the world
+// recycles the same memory instead of fragmenting the (fixed) wasm heap.
+// Live objects are also tracked in a dense array for cheap iteration.
+// Not thread-safe: callers serialise create/destroy.
+template <typename T, size_t SLAB_SIZE = 64>
+class SlabPool {
+public:
+    using Stats = SlabPoolStats;
+
+    SlabPool() = default;
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    ~SlabPool() {
+        for (Slot* slot : live) {
+            slot->object()->~T();
+        }
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Slot* slot = free_list;
+        if (slot) {
+            free_list = slot->next_free;
+            ++recycled;
+        } else {
+            slot = grow();
+        }
+        T* obj = new (slot->storage) T(std::forward<Args>(args)...);
+        slot->live_index = live.size();
+        live.push_back(slot);
+        if (live.size() > high_water) high_water = live.size();
+        return obj;
+    }
+
+    void destroy(T* obj) {
+        if (!obj) return;
+        Slot* slot = reinterpret_cast<Slot*>(obj);
+        obj->~T();
+        // Swap-remove keeps the live array packed
+        Slot* last = live.back();
+        live[slot->live_index] = last;
+        last->live_index = slot->live_index;
+        live.pop_back();
+        slot->next_free = free_list;
+        free_list = slot;
+    }
+
+    size_t live_count() const { return live.size(); }
+    T* live_at(size_t i) const { return live[i]->object(); }
+
+    Stats stats() const {
+        Stats s;
+        s.slabs = slabs.size();
+        s.capacity = slabs.size() * SLAB_SIZE;
+        s.live = live.size();
+        s.high_water = high_water;
+        s.recycled = recycled;
+        return s;
+    }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        Slot* next_free = nullptr;
+        size_t live_index = 0;
+
+        T* object() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    Slot* grow() {
+        slabs.push_back(std::make_unique<Slot[]>(SLAB_SIZE));
+        Slot* slab = slabs.back().get();
+        // Hand out slot 0 now, chain the rest in address order
+        for (size_t i = SLAB_SIZE - 1; i > 0; --i) {
+            slab[i].next_free = free_list;
+            free_list = &slab[i];
+        }
+        return &slab[0];
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    Slot* free_list = nullptr;
+    std::vector<Slot*> live;
+    size_t high_water = 0;
+    size_t recycled = 0;
+};
+
+#endif // SLAB_POOL_H
@@ -9,4 +9,9 @@ enum class GameMode {
 GameMode get_mode();
 void set_mode(GameMode mode);
 
+// Frames are only drawn while something changes. Input, resizes and mode
+// switches wake the loop on their own; anything animating (battle steps,
+// live particles) calls this every frame it still needs the next one.
+void request_redraw();
+
 #endif // STATES_HPP
@@ -0,0 +1,42 @@
+#include "stream_buffer.h"
+
+// Smallest allocation, so a quiet frame doesn't shrink-and-grow the buffer
+static const size_t MIN_CAPACITY = 64 * 1024;
+
+StreamBuffer::~StreamBuffer() {
+    for (GLuint& vbo : vbos) {
+        if (vbo) glDeleteBuffers(1, &vbo);
+    }
+}
+
+GLint StreamBuffer::append(const void* vertices, int count, size_t stride) {
+    // Pad so the range starts on a whole vertex of this layout
+    size_t offset = (staging.size() + stride - 1) / stride * stride;
+    const unsigned char* bytes = static_cast<const unsigned char*>(vertices);
+    staging.resize(offset);
+    staging.insert(staging.end(), bytes, bytes + count * stride);
+    return (GLint)(offset / stride);
+}
+
+GLuint StreamBuffer::buffer() {
+    if (!vbos[current]) glGenBuffers(1, &vbos[current]);
+    return vbos[current];
+}
+
+size_t StreamBuffer::upload() {
+    if (staging.empty()) return 0;
+    size_t bytes = staging.size();
+    size_t& cap = capacity[current];
+    while (cap < bytes) cap = cap ? cap * 2 : MIN_CAPACITY;
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer());
+    // Orphan: fresh storage, the old one is released once the GPU is done
+    glBufferData(GL_ARRAY_BUFFER, cap, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, staging.data());
+    staging.clear();
+    return bytes;
+}
+
+void StreamBuffer::next_frame() {
+    current = (current + 1) % RING_SIZE;
+}
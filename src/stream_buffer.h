@@ -0,0 +1,42 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include "gl.h"
+#include <cstddef>
+#include <vector>
+#include "geometry.h"
+
+// Per-frame vertex data (the player ship, later particles and batches).
+// Vertices are staged on the CPU while commands are recorded and uploaded
+// with one glBufferSubData per frame into a ring of buffers. Each upload
+// orphans its buffer first (glBufferData with no data), so the driver never
+// waits for the GPU to finish reading last frame's vertices, and cycling
+// through the ring keeps that true on implementations that don't rename.
+class StreamBuffer {
+public:
+    static const int RING_SIZE = 3;
+
+    ~StreamBuffer();
+
+    // Stages vertices of any layout for this frame; returns the index of
+    // the first one, in units of stride
+    GLint append(const void* vertices, int count, size_t stride);
+    template <typename Vertex>
+    GLint append(const Vertex* vertices, int count) {
+        return append(vertices, count, sizeof(Vertex));
+    }
+    // Buffer this frame's staged vertices will be uploaded into
+    GLuint buffer();
+    // Uploads everything staged this frame; returns the bytes streamed
+    size_t upload();
+    // Moves to the next buffer of the ring once the frame's draws are issued
+    void next_frame();
+
+private:
+    GLuint vbos[RING_SIZE] = {};
+    size_t capacity[RING_SIZE] = {};
+    int current = 0;
+    std::vector<unsigned char> staging;
+};
+
+#endif // STREAM_BUFFER_H
@@ -0,0 +1,89 @@
+#include "tilemap.h"
+#include "geometry.h"
+#include "world.h"
+#include <cmath>
+
+static int wrap(int v, int n) {
+    int m = v % n;
+    return m < 0 ? m + n : m;
+}
+
+TileMapRenderer::~TileMapRenderer() {
+    if (texture) glDeleteTextures(1, &texture);
+}
+
+void TileMapRenderer::ensure_texture() {
+    if (texture) return;
+    std::vector<GLubyte> empty(TEXTURE_TILES * TEXTURE_TILES, (GLubyte)Tiles::EMPTY);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, TEXTURE_TILES, TEXTURE_TILES, 0,
+                 GL_LUMINANCE, GL_UNSIGNED_BYTE, empty.data());
+}
+
+void TileMapRenderer::sync(const std::vector<std::pair<Point, const Chunk*>>& active) {
+    ensure_texture();
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    last_uploads = 0;
+    GLubyte texels[Chunk::SIZE * Chunk::SIZE];
+    for (const auto& [coord, chunk] : active) {
+        int sx = wrap(coord.first, WINDOW_CHUNKS);
+        int sy = wrap(coord.second, WINDOW_CHUNKS);
+        Slot& slot = slots[sx][sy];
+        if (slot.resident && slot.coord == coord) continue;
+
+        // Texture rows run along y
+        for (int y = 0; y < Chunk::SIZE; ++y) {
+            for (int x = 0; x < Chunk::SIZE; ++x) {
+                texels[y * Chunk::SIZE + x] = (GLubyte)chunk->get_tile(x, y);
+            }
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, sx * Chunk::SIZE, sy * Chunk::SIZE, Chunk::SIZE, Chunk::SIZE,
+                        GL_LUMINANCE, GL_UNSIGNED_BYTE, texels);
+        slot.coord = coord;
+        slot.resident = true;
+        ++last_uploads;
+    }
+}
+
+void TileMapRenderer::set_uniforms(GLuint program, const void* user) {
+    const TileMapRenderer* self = static_cast<const TileMapRenderer*>(user);
+    glUniform1i(uniform_location(program, "tiles"), 0);
+    glUniform1f(uniform_location(program, "texture_tiles"), (float)TEXTURE_TILES);
+    glUniform2fv(uniform_location(program, "cam_offset"), 1, self->cam_offset);
+    glUniform2fv(uniform_location(program, "anchor_mod"), 1, self->anchor_mod);
+    glUniform2fv(uniform_location(program, "half_extent"), 1, self->half_extent);
+}
+
+void TileMapRenderer::draw(GLuint program, GLuint quad_vbo, float camX, float camY, float aspect, float zoom) {
+    if (!texture) return;
+
+    // Same anchor as the rest of the world pass keeps shader maths small
+    const CameraAnchor& anchor = get_camera_anchor();
+    cam_offset[0] = (camX - anchor.x) / TILE_SIZE;
+    cam_offset[1] = (camY - anchor.y) / TILE_SIZE;
+    anchor_mod[0] = (float)wrap((int)std::lround(anchor.x / TILE_SIZE), TEXTURE_TILES);
+    anchor_mod[1] = (float)wrap((int)std::lround(anchor.y / TILE_SIZE), TEXTURE_TILES);
+    half_extent[0] = aspect / zoom / TILE_SIZE;
+    half_extent[1] = 1.0f / zoom / TILE_SIZE;
+
+    // squareVbo spans [0, 1]^2, stretch it over clip space
+    DrawCommand cmd;
+    cmd.program = program;
+    cmd.vbo = quad_vbo;
+    cmd.texture = texture;
+    cmd.blend = true;
+    cmd.mode = GL_TRIANGLE_FAN;
+    cmd.count = 4;
+    cmd.custom_uniforms = &TileMapRenderer::set_uniforms;
+    cmd.user = this;
+    make_transform(cmd.transform, -1.0f, -1.0f, 2.0f, 2.0f);
+    submit_draw(cmd);
+}
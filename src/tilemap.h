@@ -0,0 +1,47 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "gl.h"
+#include <utility>
+#include <vector>
+#include "chunk.h"
+
+// Draws the whole visible map as one full-screen quad. Tile ids of a
+// window of chunks live in a LUMINANCE texture (one texel per tile),
+// addressed toroidally by world tile coordinate, so a chunk is uploaded
+// once when it enters the window and the fragment shader does the rest:
+// tile colours plus procedural planet and asteroid discs.
+class TileMapRenderer {
+public:
+    static const int TEXTURE_TILES = 512; // power of two, for GL_REPEAT
+    static const int WINDOW_CHUNKS = TEXTURE_TILES / Chunk::SIZE;
+
+    ~TileMapRenderer();
+
+    // Uploads chunks that are not resident in their texture slot yet
+    void sync(const std::vector<std::pair<Point, const Chunk*>>& active);
+    // Records the full-screen draw; program is the tilemap shader
+    void draw(GLuint program, GLuint quad_vbo, float camX, float camY, float aspect, float zoom);
+
+    int uploads() const { return last_uploads; }
+
+private:
+    struct Slot {
+        Point coord{0, 0};
+        bool resident = false;
+    };
+
+    static void set_uniforms(GLuint program, const void* user);
+    void ensure_texture();
+
+    GLuint texture = 0;
+    Slot slots[WINDOW_CHUNKS][WINDOW_CHUNKS];
+    int last_uploads = 0;
+
+    // Uniform values for the current frame
+    float cam_offset[2] = {};
+    float anchor_mod[2] = {};
+    float half_extent[2] = {};
+};
+
+#endif // TILEMAP_H
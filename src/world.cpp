@@ -0,0 +1,105 @@
+#include "world.h"
+#include <cmath>
+#include <cstdint>
+
+const float TILE_SIZE = 1.0f;
+const float TILE_OVERHANG = 0.4f;
+
+// Chunks further than this (in chunks) outside the active window are evicted
+const int CHUNK_EVICT_MARGIN = 8;
+
+int PlanetGenerator::hash(int x, int y) const {
+    int h = seed;
+    h ^= x * 73856093ULL;
+    h ^= y * 19349663ULL;
+    h ^= (h >> 13);
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= (h >> 13);
+    return h;
+}
+Point PlanetGenerator::get_planet_in_cell(int cell_x, int cell_y) const {
+    int h = hash(cell_x, cell_y);
+    uint64_t seed = hash(cell_x, cell_y);
+    int offsetX = seed % cell_size;
+    int offsetY = (seed >> 16) % cell_size;
+    return {cell_x * cell_size + offsetX, cell_y * cell_size + offsetY};
+}
+bool PlanetGenerator::is_planet_at(int tile_x, int tile_y) const {
+    auto [cell_x, cell_y] = tile_to_cell(tile_x, tile_y);
+    auto [planet_x, planet_y] = get_planet_in_cell(cell_x, cell_y);
+    return (planet_x == tile_x && planet_y == tile_y);
+}
+WorldMap::WorldMap(int seed)
+    : seed(seed), terrainNoise(seed), asteroidNoise(seed), pathNoise(seed + 123), pl_gen(seed) {}
+Tiles WorldMap::get_tile_at(int x, int y) {
+    int chunk_x = x / Chunk::SIZE;
+    int chunk_y = y / Chunk::SIZE;
+    int local_x = x % Chunk::SIZE;
+    int local_y = y % Chunk::SIZE;
+
+    return get_chunk(chunk_x, chunk_y)->get_tile(local_x, local_y);
+}
+const Chunk* WorldMap::get_chunk(int chunk_x, int chunk_y) {
+    const Chunk* chunk = chunks.find({chunk_x, chunk_y});
+    if (!chunk) {
+        chunk = generate_chunk(chunk_x, chunk_y);
+    }
+    return chunk;
+}
+void WorldMap::set_active_chunks(const Camera& camera) {
+    TileRect range = camera.chunk_range(TILE_OVERHANG);
+    if (range == active_range && !active_chunks.empty()) return;
+    active_range = range;
+    this->active_chunks.clear();
+    ++active_version;
+    for (int cx = range.min_x; cx <= range.max_x; ++cx) {
+        for (int cy = range.min_y; cy <= range.max_y; ++cy) {
+            this->active_chunks.push_back({{cx, cy}, get_chunk(cx, cy)});
+        }
+    }
+    // Active chunks are inside the kept window, so their pointers stay valid
+    chunks.evict_outside({range.min_x - CHUNK_EVICT_MARGIN, range.min_y - CHUNK_EVICT_MARGIN},
+                         {range.max_x + CHUNK_EVICT_MARGIN, range.max_y + CHUNK_EVICT_MARGIN});
+}
+
+// Per-tile dice roll that only depends on the seed and position, so evicted
+// chunks regenerate identically
+static uint32_t tile_roll(int seed, int x, int y) {
+    uint32_t h = (uint32_t)seed * 0x9e3779b9u;
+    h ^= (uint32_t)x * 73856093u;
+    h ^= (uint32_t)y * 19349663u;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+const Chunk* WorldMap::generate_chunk(int chunk_x, int chunk_y) {
+    Chunk new_chunk;
+    for (int x = 0; x < Chunk::SIZE; ++x) {
+        for (int y = 0; y < Chunk::SIZE; ++y) {
+            int world_x = chunk_x * Chunk::SIZE + x;
+            int world_y = chunk_y * Chunk::SIZE + y;
+
+            // Sample lazily: asteroid noise only matters inside safe zones
+            float terrain_value = terrainNoise(world_x, world_y);
+            if (terrain_value > 0.5f) {
+                if (pl_gen.is_planet_at(world_x, world_y)) {
+                    new_chunk.tiles[x][y] = Tiles::PLANET;
+                } else if (asteroidNoise(world_x, world_y) > 0.4f) {
+                    new_chunk.tiles[x][y] = Tiles::ASTEROID;
+                } else {
+                    new_chunk.tiles[x][y] = Tiles::EMPTY;
+                }
+            } else if (terrain_value < -0.7f && tile_roll(seed, world_x, world_y) % 100 == 0) {
+                new_chunk.tiles[x][y] = Tiles::RESOURCES;
+            } 
+            else {
+                new_chunk.tiles[x][y] = Tiles::DANGEROUS;
+            }
+        }
+    }
+    return chunks.publish({chunk_x, chunk_y}, new_chunk);
+}
@@ -0,0 +1,67 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "world_noise.h"
+#include "chunk_store.h"
+#include "camera.h"
+
+// World generation and chunk streaming. Depends on nothing but the seed, so
+// tools and benchmarks can build worlds without a window or game state.
+
+// Constants
+extern const float TILE_SIZE;
+// Planet discs reach this far (world units) past their own tile
+extern const float TILE_OVERHANG;
+
+class PlanetGenerator {
+    static const int cell_size = Chunk::SIZE * 6; // Each cell covers multiple chunks
+    int seed;
+    public:
+    explicit PlanetGenerator(int seed) : seed(seed) {}
+    int hash(int x, int y) const;
+    Point tile_to_cell(int tile_x, int tile_y) const {
+        int cell_x = std::floor((float)(tile_x * TILE_SIZE) / (float)cell_size);
+        int cell_y = std::floor((float)(tile_y * TILE_SIZE) / (float)cell_size);
+        return {cell_x, cell_y};
+    }
+    Point get_planet_in_cell(int cell_x, int cell_y) const;
+    bool is_planet_at(int tile_x, int tile_y) const;
+};
+class WorldMap {
+    int seed;
+    TerrainNoise terrainNoise;
+    AsteroidNoise asteroidNoise;
+    PathNoise pathNoise;
+    PlanetGenerator pl_gen;
+    std::vector<std::pair<Point, const Chunk*>> active_chunks;
+    unsigned active_version = 0;
+    TileRect active_range{0, 0, -1, -1};
+    public:
+    WorldMap(int seed = 1);
+    ChunkStore chunks;
+    Tiles get_tile_at(int x, int y);
+    // Makes the chunks the camera can see active; a no-op while the visible
+    // chunk range is unchanged
+    void set_active_chunks(const Camera& camera);
+    const Chunk* get_chunk(int chunk_x, int chunk_y);
+    const Chunk* generate_chunk(int chunk_x, int chunk_y);
+    std::pair<float, float> chunk_to_world(Point chunk_coord) {
+        return {chunk_coord.first * Chunk::SIZE * TILE_SIZE, chunk_coord.second * Chunk::SIZE * TILE_SIZE};
+    }
+    const std::vector<std::pair<Point, const Chunk*>>& get_active_chunks() const {
+        return active_chunks;
+    }
+    // Bumped whenever the active set is rebuilt
+    unsigned get_active_version() const {
+        return active_version;
+    }
+    const TileRect& get_active_range() const {
+        return active_range;
+    }
+    
+};
+
+#endif // WORLD_H
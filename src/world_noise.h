@@ -0,0 +1,328 @@
+#ifndef WORLD_NOISE_H
+#define WORLD_NOISE_H
+
+#include <FastNoiseLite.h>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+// FastNoiseLite's 2D noise, specialised at compile time for the layers the
+// world generator uses. GetNoise switches on the noise type, fractal type
+// and cellular settings on every sample; here the configuration is a
+// NoiseLayer's type, so a sample is one inlined kernel with the octaves
+// unrolled. The kernels follow FastNoiseLite's code operation for
+// operation, so they return exactly what GetNoise does: noise_check
+// compares the two, noise_bench times them.
+namespace noise_kernel {
+
+// Lattice coordinates are multiplied by these and hashed. FastNoiseLite
+// does it in int and relies on overflow wrapping; unsigned gives the same
+// bits without the undefined behaviour.
+constexpr uint32_t PRIME_X = 501125321;
+constexpr uint32_t PRIME_Y = 1136930381;
+
+constexpr float SQRT3 = (float)1.7320508075688772935274463415059;
+// Simplex skew and unskew factors, rounded to float like FastNoiseLite's
+constexpr float F2 = 0.5f * (SQRT3 - 1);
+constexpr float G2 = (3 - SQRT3) / 6;
+constexpr float CELLULAR_JITTER = 0.43701595f;
+
+// FastNoiseLite's gradient table: 24 directions repeated five times, then
+// the 8 diagonals, so a 7-bit hash picks one
+constexpr float GRADIENT_DIRECTIONS[48] = {
+    0.130526192220052f, 0.99144486137381f, 0.38268343236509f, 0.923879532511287f,
+    0.608761429008721f, 0.793353340291235f, 0.793353340291235f, 0.608761429008721f,
+    0.923879532511287f, 0.38268343236509f, 0.99144486137381f, 0.130526192220051f,
+    0.99144486137381f, -0.130526192220051f, 0.923879532511287f, -0.38268343236509f,
+    0.793353340291235f, -0.60876142900872f, 0.608761429008721f, -0.793353340291235f,
+    0.38268343236509f, -0.923879532511287f, 0.130526192220052f, -0.99144486137381f,
+    -0.130526192220052f, -0.99144486137381f, -0.38268343236509f, -0.923879532511287f,
+    -0.608761429008721f, -0.793353340291235f, -0.793353340291235f, -0.608761429008721f,
+    -0.923879532511287f, -0.38268343236509f, -0.99144486137381f, -0.130526192220052f,
+    -0.99144486137381f, 0.130526192220051f, -0.923879532511287f, 0.38268343236509f,
+    -0.793353340291235f, 0.608761429008721f, -0.608761429008721f, 0.793353340291235f,
+    -0.38268343236509f, 0.923879532511287f, -0.130526192220052f, 0.99144486137381f,
+};
+constexpr float GRADIENT_DIAGONALS[16] = {
+    0.38268343236509f, 0.923879532511287f, 0.923879532511287f, 0.38268343236509f,
+    0.923879532511287f, -0.38268343236509f, 0.38268343236509f, -0.923879532511287f,
+    -0.38268343236509f, -0.923879532511287f, -0.923879532511287f, -0.38268343236509f,
+    -0.923879532511287f, 0.38268343236509f, -0.38268343236509f, 0.923879532511287f,
+};
+constexpr std::array<float, 256> GRADIENTS_2D = [] {
+    std::array<float, 256> table{};
+    for (int i = 0; i < 240; ++i) table[i] = GRADIENT_DIRECTIONS[i % 48];
+    for (int i = 0; i < 16; ++i) table[240 + i] = GRADIENT_DIAGONALS[i];
+    return table;
+}();
+
+constexpr int fast_floor(float f) { return f >= 0 ? (int)f : (int)f - 1; }
+constexpr int fast_round(float f) { return f >= 0 ? (int)(f + 0.5f) : (int)(f - 0.5f); }
+constexpr float fast_abs(float f) { return f < 0 ? -f : f; }
+constexpr float lerp(float a, float b, float t) { return a + t * (b - a); }
+constexpr float interp_quintic(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
+
+inline int hash(int seed, uint32_t x_primed, uint32_t y_primed) {
+    uint32_t h = (uint32_t)seed ^ x_primed ^ y_primed;
+    h *= 0x27d4eb2du;
+    return (int)h;
+}
+
+inline float grad_coord(int seed, uint32_t x_primed, uint32_t y_primed, float xd, float yd) {
+    int h = hash(seed, x_primed, y_primed);
+    h ^= h >> 15;
+    h &= 127 << 1;
+    return xd * GRADIENTS_2D[h] + yd * GRADIENTS_2D[h | 1];
+}
+
+inline float perlin(int seed, float x, float y) {
+    int x0 = fast_floor(x);
+    int y0 = fast_floor(y);
+
+    float xd0 = x - x0;
+    float yd0 = y - y0;
+    float xd1 = xd0 - 1;
+    float yd1 = yd0 - 1;
+
+    float xs = interp_quintic(xd0);
+    float ys = interp_quintic(yd0);
+
+    uint32_t xp0 = (uint32_t)x0 * PRIME_X;
+    uint32_t yp0 = (uint32_t)y0 * PRIME_Y;
+    uint32_t xp1 = xp0 + PRIME_X;
+    uint32_t yp1 = yp0 + PRIME_Y;
+
+    float xf0 = lerp(grad_coord(seed, xp0, yp0, xd0, yd0), grad_coord(seed, xp1, yp0, xd1, yd0), xs);
+    float xf1 = lerp(grad_coord(seed, xp0, yp1, xd0, yd1), grad_coord(seed, xp1, yp1, xd1, yd1), xs);
+    return lerp(xf0, xf1, ys) * 1.4247691104677813f;
+}
+
+// Adds the contribution of the vertex at primed lattice position (i, j),
+// (x, y) away, if it is in range
+inline void open_simplex2s_vertex(float& value, int seed, uint32_t i, uint32_t j, float x, float y) {
+    float a = (2.0f / 3.0f) - x * x - y * y;
+    if (a > 0) value += (a * a) * (a * a) * grad_coord(seed, i, j, x, y);
+}
+
+// Takes coordinates already skewed by F2, as GetNoise passes them
+inline float open_simplex2s(int seed, float x, float y) {
+    int x_floor = fast_floor(x);
+    int y_floor = fast_floor(y);
+    float xi = x - x_floor;
+    float yi = y - y_floor;
+
+    uint32_t i = (uint32_t)x_floor * PRIME_X;
+    uint32_t j = (uint32_t)y_floor * PRIME_Y;
+    uint32_t i1 = i + PRIME_X;
+    uint32_t j1 = j + PRIME_Y;
+
+    float t = (xi + yi) * G2;
+    float x0 = xi - t;
+    float y0 = yi - t;
+
+    float a0 = (2.0f / 3.0f) - x0 * x0 - y0 * y0;
+    float value = (a0 * a0) * (a0 * a0) * grad_coord(seed, i, j, x0, y0);
+
+    float a1 = (float)(2 * (1 - 2 * G2) * (1 / G2 - 2)) * t + ((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2)) + a0);
+    float x1 = x0 - (float)(1 - 2 * G2);
+    float y1 = y0 - (float)(1 - 2 * G2);
+    value += (a1 * a1) * (a1 * a1) * grad_coord(seed, i1, j1, x1, y1);
+
+    // The two vertices nearest the point out of the four around this cell
+    float xmyi = xi - yi;
+    if (t > G2) {
+        if (xi + xmyi > 1) {
+            open_simplex2s_vertex(value, seed, i + (PRIME_X << 1), j + PRIME_Y, x0 + (float)(3 * G2 - 2),
+                                  y0 + (float)(3 * G2 - 1));
+        } else {
+            open_simplex2s_vertex(value, seed, i, j + PRIME_Y, x0 + (float)G2, y0 + (float)(G2 - 1));
+        }
+        if (yi - xmyi > 1) {
+            open_simplex2s_vertex(value, seed, i + PRIME_X, j + (PRIME_Y << 1), x0 + (float)(3 * G2 - 1),
+                                  y0 + (float)(3 * G2 - 2));
+        } else {
+            open_simplex2s_vertex(value, seed, i + PRIME_X, j, x0 + (float)(G2 - 1), y0 + (float)G2);
+        }
+    } else {
+        if (xi + xmyi < 0) {
+            open_simplex2s_vertex(value, seed, i - PRIME_X, j, x0 + (float)(1 - G2), y0 - (float)G2);
+        } else {
+            open_simplex2s_vertex(value, seed, i + PRIME_X, j, x0 + (float)(G2 - 1), y0 + (float)G2);
+        }
+        if (yi < xmyi) {
+            open_simplex2s_vertex(value, seed, i, j - PRIME_Y, x0 - (float)G2, y0 - (float)(G2 - 1));
+        } else {
+            open_simplex2s_vertex(value, seed, i, j + PRIME_Y, x0 + (float)G2, y0 + (float)(G2 - 1));
+        }
+    }
+    return value * 18.24196194486065f;
+}
+
+// FastNoiseLite's default cellular setup: squared euclidean distance to the
+// nearest jittered cell point, minus one. jitter is cellular_jitter_vectors().
+inline float cellular_distance(int seed, float x, float y, const float* jitter) {
+    int xr = fast_round(x);
+    int yr = fast_round(y);
+
+    float distance0 = 1e10f;
+    uint32_t x_primed = (uint32_t)(xr - 1) * PRIME_X;
+    uint32_t y_primed_base = (uint32_t)(yr - 1) * PRIME_Y;
+    for (int xi = xr - 1; xi <= xr + 1; xi++) {
+        uint32_t y_primed = y_primed_base;
+        for (int yi = yr - 1; yi <= yr + 1; yi++) {
+            int idx = hash(seed, x_primed, y_primed) & (255 << 1);
+            float vec_x = (float)(xi - x) + jitter[idx] * CELLULAR_JITTER;
+            float vec_y = (float)(yi - y) + jitter[idx | 1] * CELLULAR_JITTER;
+            float distance = vec_x * vec_x + vec_y * vec_y;
+            if (distance < distance0) distance0 = distance;
+            y_primed += PRIME_Y;
+        }
+        x_primed += PRIME_X;
+    }
+    return distance0 - 1;
+}
+
+// FastNoiseLite's 256 random unit vectors for cellular jitter. The table is
+// private, but BasicGrid domain warp reads the same one and, at the origin
+// with unit amplitude and one octave, adds an entry to the point unchanged.
+// Seed s lands on entry hash(s, 0, 0), and seeds 0..511 reach all of them.
+inline const float* cellular_jitter_vectors() {
+    static const std::array<float, 512> table = [] {
+        std::array<float, 512> vectors{};
+        FastNoiseLite noise;
+        noise.SetDomainWarpType(FastNoiseLite::DomainWarpType_BasicGrid);
+        noise.SetDomainWarpAmp(1.0f);
+        noise.SetFractalOctaves(1);
+        for (int seed = 0; seed < 512; ++seed) {
+            noise.SetSeed(seed);
+            float x = 0.0f, y = 0.0f;
+            noise.DomainWarp(x, y);
+            int idx = hash(seed, 0, 0) & (255 << 1);
+            vectors[idx] = x;
+            vectors[idx | 1] = y;
+        }
+        return vectors;
+    }();
+    return table.data();
+}
+
+} // namespace noise_kernel
+
+// A FastNoiseLite configuration as a type. Only the noise and fractal types
+// the world uses have kernels: OpenSimplex2S, Perlin and Cellular (with
+// FastNoiseLite's default cellular settings), unfractaled or ridged. The
+// domain warp settings only matter to FastNoiseLite::DomainWarp, which the
+// generator does not call; reference() still applies them.
+template <FastNoiseLite::NoiseType Type,
+          float Frequency,
+          FastNoiseLite::FractalType Fractal = FastNoiseLite::FractalType_None,
+          int Octaves = 3,
+          float Lacunarity = 2.0f,
+          float Gain = 0.5f,
+          float WeightedStrength = 0.0f,
+          FastNoiseLite::DomainWarpType WarpType = FastNoiseLite::DomainWarpType_OpenSimplex2,
+          float WarpAmp = 1.0f>
+struct NoiseLayer {
+    static_assert(Type == FastNoiseLite::NoiseType_OpenSimplex2S || Type == FastNoiseLite::NoiseType_Perlin ||
+                      Type == FastNoiseLite::NoiseType_Cellular,
+                  "no kernel for this noise type");
+    static_assert(Fractal == FastNoiseLite::FractalType_None || Fractal == FastNoiseLite::FractalType_Ridged,
+                  "no kernel for this fractal type");
+
+    static constexpr FastNoiseLite::NoiseType noise_type = Type;
+    static constexpr FastNoiseLite::FractalType fractal_type = Fractal;
+    static constexpr bool is_fractal = Fractal != FastNoiseLite::FractalType_None;
+
+    // Scales the octave sum into [-1, 1], computed as FastNoiseLite does
+    static constexpr float fractal_bounding = [] {
+        float gain = noise_kernel::fast_abs(Gain);
+        float amp = gain;
+        float amp_fractal = 1.0f;
+        for (int i = 1; i < Octaves; i++) {
+            amp_fractal += amp;
+            amp *= gain;
+        }
+        return 1 / amp_fractal;
+    }();
+
+    int seed;
+    const float* jitter = nullptr; // cellular layers only
+
+    explicit NoiseLayer(int seed) : seed(seed) {
+        if constexpr (Type == FastNoiseLite::NoiseType_Cellular) jitter = noise_kernel::cellular_jitter_vectors();
+    }
+
+    // A FastNoiseLite set up the same way; its GetNoise returns what
+    // sample() does
+    static FastNoiseLite reference(int seed) {
+        FastNoiseLite noise(seed);
+        noise.SetNoiseType(Type);
+        noise.SetFrequency(Frequency);
+        if constexpr (is_fractal) {
+            noise.SetFractalType(Fractal);
+            noise.SetFractalOctaves(Octaves);
+            noise.SetFractalLacunarity(Lacunarity);
+            noise.SetFractalGain(Gain);
+            noise.SetFractalWeightedStrength(WeightedStrength);
+        }
+        noise.SetDomainWarpType(WarpType);
+        noise.SetDomainWarpAmp(WarpAmp);
+        return noise;
+    }
+
+    float operator()(int x, int y) const {
+        return sample((float)x, (float)y);
+    }
+
+    float sample(float x, float y) const {
+        x *= Frequency;
+        y *= Frequency;
+        if constexpr (Type == FastNoiseLite::NoiseType_OpenSimplex2S) {
+            float t = (x + y) * noise_kernel::F2;
+            x += t;
+            y += t;
+        }
+        if constexpr (!is_fractal) {
+            return single(seed, x, y);
+        } else {
+            float sum = 0;
+            float amp = fractal_bounding;
+            [&]<int... Octave>(std::integer_sequence<int, Octave...>) {
+                (ridged_octave(seed + Octave, x, y, sum, amp), ...);
+            }(std::make_integer_sequence<int, Octaves>{});
+            return sum;
+        }
+    }
+
+private:
+    float single(int octave_seed, float x, float y) const {
+        if constexpr (Type == FastNoiseLite::NoiseType_OpenSimplex2S) {
+            return noise_kernel::open_simplex2s(octave_seed, x, y);
+        } else if constexpr (Type == FastNoiseLite::NoiseType_Perlin) {
+            return noise_kernel::perlin(octave_seed, x, y);
+        } else {
+            return noise_kernel::cellular_distance(octave_seed, x, y, jitter);
+        }
+    }
+
+    void ridged_octave(int octave_seed, float& x, float& y, float& sum, float& amp) const {
+        float noise = noise_kernel::fast_abs(single(octave_seed, x, y));
+        sum += (noise * -2 + 1) * amp;
+        if constexpr (WeightedStrength != 0.0f) amp *= noise_kernel::lerp(1.0f, 1 - noise, WeightedStrength);
+        x *= Lacunarity;
+        y *= Lacunarity;
+        amp *= Gain;
+    }
+};
+
+// Zone layout: ridged OpenSimplex2S, large features
+using TerrainNoise = NoiseLayer<FastNoiseLite::NoiseType_OpenSimplex2S, 0.03f,
+                                FastNoiseLite::FractalType_Ridged, 2, 1.0f, 35.0f, 0.07f,
+                                FastNoiseLite::DomainWarpType_OpenSimplex2, 2.5f>;
+// Asteroid fields inside safe zones
+using AsteroidNoise = NoiseLayer<FastNoiseLite::NoiseType_Perlin, 0.3f>;
+// Travel paths (not sampled by the generator yet)
+using PathNoise = NoiseLayer<FastNoiseLite::NoiseType_Cellular, 0.005f,
+                             FastNoiseLite::FractalType_Ridged>;
+
+#endif // WORLD_NOISE_H
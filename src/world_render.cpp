@@ -0,0 +1,123 @@
+#include "world_render.h"
+#include "geometry.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+bool g_use_tilemap = true;
+static ChunkMeshCache chunk_meshes;
+static TileMapRenderer tilemap;
+
+const ChunkMeshCache& world_chunk_meshes() {
+    return chunk_meshes;
+}
+
+const TileMapRenderer& world_tilemap() {
+    return tilemap;
+}
+
+// Grid lines closer than this on screen are merged into a coarser grid
+static const float GRID_MIN_SPACING_PX = 8.0f;
+// ...and fade in over this range of spacing, so density changes smoothly
+static const float GRID_FADE_SPACING_PX = 16.0f;
+
+// All grid lines as one GL_LINES batch around the origin, rebuilt only when
+// the zoom level or viewport shape changes. The grid is periodic, so the
+// same batch is reused at any camera position by snapping its origin.
+struct GridMesh {
+    GLuint vbo = 0;
+    GLsizei vertex_count = 0;
+    int step = 1; // tiles between lines
+    float zoom = 0.0f;
+    float aspect = 0.0f;
+    int screen_height = 0;
+
+    void build(const Camera& camera, int new_screen_height) {
+        aspect = camera.aspect;
+        zoom = camera.zoom;
+        screen_height = new_screen_height;
+
+        // Pixels between neighbouring tile lines
+        float tile_px = TILE_SIZE * zoom * screen_height * 0.5f;
+        step = 1;
+        while (tile_px * step < GRID_MIN_SPACING_PX) step *= 2;
+        // Every other line fades out as it approaches the minimum spacing
+        float fine_px = tile_px * step;
+        float fade = std::min(1.0f, (fine_px - GRID_MIN_SPACING_PX) / (GRID_FADE_SPACING_PX - GRID_MIN_SPACING_PX));
+        GLubyte fine_alpha = (GLubyte)(255.0f * std::max(fade, 0.0f));
+
+        // Visible half extents in tiles, plus the up to two steps the origin
+        // is snapped behind the camera
+        ViewRect view = camera.view_rect();
+        float half_w = (view.max_x - view.min_x) * 0.5f;
+        float half_h = (view.max_y - view.min_y) * 0.5f;
+        int rx = (int)ceil(half_w / TILE_SIZE / step) * step + 2 * step;
+        int ry = (int)ceil(half_h / TILE_SIZE / step) * step + 2 * step;
+
+        std::vector<ColorVertex> verts;
+        const GLubyte r = 51, g = 51, b = 77; // (0.2, 0.2, 0.3)
+        for (int x = -rx; x <= rx; x += step) {
+            GLubyte a = ((x / step) % 2 == 0) ? 255 : fine_alpha;
+            verts.push_back({x * TILE_SIZE, -ry * TILE_SIZE, r, g, b, a});
+            verts.push_back({x * TILE_SIZE, ry * TILE_SIZE, r, g, b, a});
+        }
+        for (int y = -ry; y <= ry; y += step) {
+            GLubyte a = ((y / step) % 2 == 0) ? 255 : fine_alpha;
+            verts.push_back({-rx * TILE_SIZE, y * TILE_SIZE, r, g, b, a});
+            verts.push_back({rx * TILE_SIZE, y * TILE_SIZE, r, g, b, a});
+        }
+
+        if (!vbo) glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(ColorVertex), verts.data(), GL_STATIC_DRAW);
+        vertex_count = (GLsizei)verts.size();
+    }
+};
+
+static GridMesh grid_mesh;
+
+void draw_grid(const Camera& camera, int screen_height, GLuint program) {
+    if (grid_mesh.zoom != camera.zoom || grid_mesh.aspect != camera.aspect || grid_mesh.screen_height != screen_height) {
+        grid_mesh.build(camera, screen_height);
+    }
+
+    // Snap to a multiple of two steps so faded lines stay on odd multiples
+    int period = 2 * grid_mesh.step;
+    const CameraAnchor& anchor = get_camera_anchor();
+    float originX = floor(camera.x / TILE_SIZE / period) * period * TILE_SIZE - anchor.x;
+    float originY = floor(camera.y / TILE_SIZE / period) * period * TILE_SIZE - anchor.y;
+
+    DrawCommand cmd;
+    cmd.program = program;
+    cmd.vbo = grid_mesh.vbo;
+    cmd.layout = VertexLayout::POSITION_COLOR;
+    cmd.blend = true;
+    cmd.mode = GL_LINES;
+    cmd.count = grid_mesh.vertex_count;
+    cmd.line_width = 2.0f;
+    cmd.camera_space = true;
+    make_transform(cmd.transform, originX, originY, 1.0f, 1.0f);
+    submit_draw(cmd);
+}
+
+void draw_map(const WorldMap& map, const Camera& camera, GLuint mesh_program, GLuint tilemap_program, GLuint quad_vbo) {
+    // Chunks are immutable, so GPU data only changes with the active set
+    static unsigned synced_version = ~0u;
+    static bool synced_tilemap = false;
+    unsigned version = map.get_active_version();
+    if (version != synced_version || g_use_tilemap != synced_tilemap) {
+        if (g_use_tilemap) {
+            chunk_meshes.clear();
+            tilemap.sync(map.get_active_chunks());
+        } else {
+            chunk_meshes.sync(map.get_active_chunks());
+        }
+        synced_version = version;
+        synced_tilemap = g_use_tilemap;
+    }
+    if (g_use_tilemap) {
+        tilemap.draw(tilemap_program, quad_vbo, camera.x, camera.y, camera.aspect, camera.zoom);
+    } else {
+        chunk_meshes.draw(mesh_program, camera);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef WORLD_RENDER_H
+#define WORLD_RENDER_H
+
+#include "gl.h"
+#include "camera.h"
+#include "chunk_mesh.h"
+#include "tilemap.h"
+#include "world.h"
+
+// Overworld scene drawing: records the grid and map commands for a camera.
+// Needs no window or game state, so the render bench drives it directly.
+
+// Tilemap draws the map in one call; chunk meshes kept for comparison
+extern bool g_use_tilemap;
+
+// Grid lines as one batch; program takes POSITION_COLOR vertices
+void draw_grid(const Camera& camera, int screen_height, GLuint program);
+// The map's active chunks, through the tilemap or the chunk meshes
+void draw_map(const WorldMap& map, const Camera& camera, GLuint mesh_program, GLuint tilemap_program, GLuint quad_vbo);
+
+const ChunkMeshCache& world_chunk_meshes();
+const TileMapRenderer& world_tilemap();
+
+#endif // WORLD_RENDER_H